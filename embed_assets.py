@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+#
+# This file is part of esp8266-io-board-websocket.
+#
+# esp8266-io-board-websocket is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# esp8266-io-board-websocket is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with esp8266-io-board-websocket.  If not, see <https://www.gnu.org/licenses/>.
+
+# Genera include/web_assets.h con la página web (html/) minificada y
+# comprimida con gzip en arreglos PROGMEM, cada uno con un hash de su
+# contenido que se usa como ETag. Las referencias del HTML a los demás
+# archivos se reescriben como <archivo>?v=<hash> (se sirven como immutable)
+# y los archivos chicos se pueden incrustar directamente en el HTML.
+#
+# Se ejecuta solo antes de compilar (extra_scripts en platformio.ini) o a mano:
+#   python3 embed_assets.py [html] [include/web_assets.h] [max. a incrustar]
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    'html': 'text/html',
+    'css': 'text/css',
+    'js': 'application/javascript',
+    'png': 'image/png',
+    'ico': 'image/x-icon',
+    'svg': 'image/svg+xml',
+}
+
+# <link rel="stylesheet" href="..."> y <script src="..."></script>
+LINK_RE = re.compile(r'<link\s+rel="stylesheet"\s+href="(?:\./)?([^"?]+)"\s*/?>')
+SCRIPT_RE = re.compile(r'<script\s+src="(?:\./)?([^"?]+)"\s*>\s*</script>')
+
+
+def minify(content, ext):
+    """Minifica con minify.py si están sus dependencias, si no lo deja igual"""
+    if ext not in ('css', 'js', 'html'):
+        return content
+    try:
+        from minify import minify_text
+    except ImportError:
+        return content
+    return minify_text(content.decode('utf-8'), ext).encode('utf-8')
+
+
+def compress(content):
+    # mtime=0 para que la salida (y el hash) solo dependa del contenido
+    return gzip.compress(content, compresslevel=9, mtime=0)
+
+
+def read_tree(src_dir):
+    files = {}
+    for root, _, names in os.walk(src_dir):
+        for name in sorted(names):
+            path = os.path.join(root, name)
+            rel = os.path.relpath(path, src_dir).replace(os.sep, '/')
+            with open(path, 'rb') as f:
+                files[rel] = f.read()
+    return dict(sorted(files.items()))
+
+
+def rewrite_html(html, base, assets, inline_max):
+    """Incrusta los archivos chicos y versiona las referencias a los demás"""
+    def resolve(ref):
+        return os.path.normpath(os.path.join(base, ref)).replace(os.sep, '/')
+
+    def link(m):
+        asset = assets.get(resolve(m.group(1)))
+        if asset is None:
+            return m.group(0)
+        if len(asset['min']) <= inline_max and b'</style' not in asset['min']:
+            asset['inlined'] = True
+            return '<style>' + asset['min'].decode('utf-8') + '</style>'
+        return m.group(0).replace(m.group(1), f"{m.group(1)}?v={asset['hash']}")
+
+    def script(m):
+        asset = assets.get(resolve(m.group(1)))
+        if asset is None:
+            return m.group(0)
+        if len(asset['min']) <= inline_max and b'</script' not in asset['min']:
+            asset['inlined'] = True
+            return '<script>' + asset['min'].decode('utf-8') + '</script>'
+        return m.group(0).replace(m.group(1), f"{m.group(1)}?v={asset['hash']}")
+
+    html = LINK_RE.sub(link, html)
+    return SCRIPT_RE.sub(script, html)
+
+
+def build_asset(rel, content):
+    ext = rel.rsplit('.', 1)[-1].lower()
+    minified = content if '.min.' in rel else minify(content, ext)
+    gz = compress(minified)
+    return {
+        'path': '/' + rel,
+        'type': CONTENT_TYPES.get(ext, 'application/octet-stream'),
+        'min': minified,
+        'gz': gz,
+        'hash': hashlib.sha256(gz).hexdigest()[:16],
+        'inlined': False,
+    }
+
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join(f'0x{b:02X}' for b in data[i:i + 16]) + ',')
+    return f'static const uint8_t {name}[] PROGMEM = {{\n' + '\n'.join(lines) + '\n};\n'
+
+
+def generate(src_dir, out_file, inline_max):
+    files = read_tree(src_dir)
+    assets = {rel: build_asset(rel, data) for rel, data in files.items()
+              if not rel.endswith('.html')}
+    pages = {}
+    for rel, data in files.items():
+        if rel.endswith('.html'):
+            base = os.path.dirname(rel)
+            html = rewrite_html(data.decode('utf-8'), base, assets, inline_max)
+            pages[rel] = build_asset(rel, html.encode('utf-8'))
+    # Los archivos incrustados en todas las páginas que los usan no se sirven
+    served = [a for a in assets.values() if not a['inlined']] + list(pages.values())
+    served.sort(key=lambda a: a['path'])
+
+    out = ['// Generado por embed_assets.py a partir de html/, no editar.',
+           '#ifndef __WEB_ASSETS_H__',
+           '#define __WEB_ASSETS_H__',
+           '',
+           '#include <WebAssets.h>',
+           '']
+    for i, a in enumerate(served):
+        out.append(f"// {a['path']}: {len(a['min'])} -> {len(a['gz'])} bytes")
+        out.append(c_array(f'WEB_ASSET_{i}', a['gz']))
+    out.append('static const WebAsset WEB_ASSETS[]{')
+    for i, a in enumerate(served):
+        out.append(f"    {{\"{a['path']}\", \"{a['type']}\", \"{a['hash']}\", "
+                   f"WEB_ASSET_{i}, sizeof(WEB_ASSET_{i})}},")
+    out.append('};')
+    out.append('')
+    out.append('#endif // __WEB_ASSETS_H__')
+    text = '\n'.join(out) + '\n'
+
+    # Solo se escribe si cambió, para no recompilar de más
+    if os.path.exists(out_file):
+        with open(out_file) as f:
+            if f.read() == text:
+                return served
+    os.makedirs(os.path.dirname(out_file) or '.', exist_ok=True)
+    with open(out_file, 'w') as f:
+        f.write(text)
+    return served
+
+
+def report(served):
+    total = sum(len(a['gz']) for a in served)
+    for a in served:
+        print(f"  {a['path']:<28} {len(a['gz']):>7} bytes  {a['hash']}")
+    print(f"Página web embebida: {len(served)} archivos, {total} bytes en flash")
+
+
+try:
+    Import('env')  # noqa: F821 (lo define PlatformIO)
+except NameError:
+    env = None
+
+if env is not None:
+    project_dir = env.subst('$PROJECT_DIR')
+    sys.path.insert(0, project_dir)
+    inline_max = int(env.GetProjectOption('custom_assets_inline_max', '8192'))
+    report(generate(os.path.join(project_dir, 'html'),
+                    os.path.join(project_dir, 'include', 'web_assets.h'),
+                    inline_max))
+elif __name__ == '__main__':
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    src = sys.argv[1] if len(sys.argv) > 1 else 'html'
+    dst = sys.argv[2] if len(sys.argv) > 2 else 'include/web_assets.h'
+    limit = int(sys.argv[3]) if len(sys.argv) > 3 else 8192
+    report(generate(src, dst, limit))
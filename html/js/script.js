@@ -15,8 +15,13 @@
 // You should have received a copy of the GNU General Public License
 // along with esp8266-io-board-websocket.  If not, see <https://www.gnu.org/licenses/>.
 
-let gateway = `ws://${window.location.hostname}/ws`
+// Protocolo binario (ver lib/BoardState/BoardState.h), si se pone en false
+// se utiliza el protocolo JSON
+const useBinary = true
+let gateway = `ws://${window.location.hostname}/ws${useBinary ? '?proto=bin' : ''}`
 let websocket
+// Último estado recibido (las tramas binarias solo traen lo que cambió)
+let boardState = { rgb: '#000000', btn1: 0, btn2: 0, ldr: 0 }
 
 window.addEventListener('load', onLoad)
 
@@ -26,6 +31,7 @@ function onLoad(event) {
 
 function initWebSocket() {
   websocket = new WebSocket(gateway)
+  websocket.binaryType = 'arraybuffer'
   websocket.onopen = onOpen
   websocket.onclose = onClose
   websocket.onmessage = onMessage
@@ -33,6 +39,8 @@ function initWebSocket() {
 
 function onOpen(event) {
   console.log('Connection opened')
+  // El firmware envía el estado cada vez que cambia (ver pushState())
+  websocket.send("sub")
 }
 
 function onClose(event) {
@@ -59,14 +67,140 @@ function setVisibility(element, on_off) {
   }
 }
 
+const STATE_BIN_VERSION = 1
+const FIELD = { RGB: 0x01, BTNS: 0x02, LDR: 0x04, TMP: 0x08, HUM: 0x10, LX: 0x20, LCD: 0x40, FX: 0x80 }
+// Efectos del LED (en el orden de RgbEffect, ver lib/RgbEffects)
+const EFFECTS = ['static', 'fade', 'breathe', 'wheel']
+
+function hex2(value) {
+  return value.toString(16).toUpperCase().padStart(2, '0')
+}
+
+function decodeBinaryState(buffer, state) {
+  const view = new DataView(buffer)
+  if (view.getUint8(0) != STATE_BIN_VERSION) return false
+  const flags = view.getUint8(1)
+  const fields = view.getUint8(2)
+  let offset = 3
+  state.lcd_connected = (flags & 0x01) != 0
+  state.aht_connected = (flags & 0x02) != 0
+  state.bh_connected = (flags & 0x04) != 0
+  if (fields & FIELD.RGB) {
+    state.rgb = '#' + hex2(view.getUint8(offset)) + hex2(view.getUint8(offset + 1)) + hex2(view.getUint8(offset + 2))
+    offset += 3
+  }
+  if (fields & FIELD.BTNS) {
+    const bits = view.getUint8(offset++)
+    state.btn1 = bits & 0x01
+    state.btn2 = (bits >> 1) & 0x01
+  }
+  if (fields & FIELD.LDR) {
+    state.ldr = view.getUint16(offset, true)
+    offset += 2
+  }
+  if (fields & FIELD.TMP) {
+    state.tmp = (view.getInt16(offset, true) / 100).toFixed(2)
+    offset += 2
+  }
+  if (fields & FIELD.HUM) {
+    state.hum = (view.getUint16(offset, true) / 100).toFixed(2)
+    offset += 2
+  }
+  if (fields & FIELD.LX) {
+    state.lx = (view.getUint32(offset, true) / 100).toFixed(2)
+    offset += 4
+  }
+  if (fields & FIELD.LCD) {
+    const rows = new TextDecoder('latin1').decode(new Uint8Array(buffer, offset, 32))
+    state.lcd1row = rows.slice(0, 16)
+    state.lcd2row = rows.slice(16, 32)
+    offset += 32
+  }
+  if (fields & FIELD.FX) {
+    state.fx = EFFECTS[view.getUint8(offset)]
+    state.fx_period = view.getUint32(offset + 1, true)
+    offset += 5
+  }
+  return true
+}
+
+// La placa no envía cada paso de un efecto: el color se anima acá
+let rgbAnimation = { key: '', frame: 0 }
+
+// Medio seno de 0 a 1 y vuelta a 0 para t de 0 a 1
+function bump(t) {
+  return (1 - Math.cos(2 * Math.PI * t)) / 2
+}
+
+function effectColor(fx, base, t) {
+  const r = parseInt(base.slice(1, 3), 16), g = parseInt(base.slice(3, 5), 16), b = parseInt(base.slice(5, 7), 16)
+  if (fx == 'fade') {
+    const c = Math.min(2, Math.floor(t * 3)), level = Math.round(255 * bump(t * 3 - c))
+    return [c == 0 ? level : 0, c == 1 ? level : 0, c == 2 ? level : 0]
+  }
+  if (fx == 'breathe') {
+    const level = bump(t)
+    return [r * level, g * level, b * level].map(Math.round)
+  }
+  if (fx == 'wheel') {
+    const hue = Math.floor(t * 255), step = (hue % 85) * 3
+    if (hue < 85) return [255 - step, step, 0]
+    if (hue < 170) return [0, 255 - step, step]
+    return [step, 0, 255 - step]
+  }
+  return [r, g, b]
+}
+
+function showRGB(data) {
+  const fx = data.fx || 'static'
+  const key = `${fx},${data.fx_period},${data.rgb}`
+  if (key == rgbAnimation.key) return
+  rgbAnimation.key = key
+  cancelAnimationFrame(rgbAnimation.frame)
+  const picker = document.getElementById("rgb").jscolor
+  if (fx == 'static' || !data.fx_period) {
+    picker.setPreviewElementBg(`${data.rgb}`)
+    return
+  }
+  const start = performance.now()
+  const step = (now) => {
+    const t = ((now - start) % data.fx_period) / data.fx_period
+    picker.setPreviewElementBg('#' + effectColor(fx, data.rgb, t).map(hex2).join(''))
+    rgbAnimation.frame = requestAnimationFrame(step)
+  }
+  rgbAnimation.frame = requestAnimationFrame(step)
+}
+
+function setButton(btn, pressed) {
+  const el = document.getElementById(`btn${btn}`)
+  el.innerHTML = (pressed == 1) ? "on" : "off"
+  el.innerHTML += '<div class="button-inner center"></div>'
+}
+
 function onMessage(event) {
-  const data = JSON.parse(event.data)
-  document.getElementById("btn1").innerHTML = (data.btn1 == 1) ? "on" : "off"
-  document.getElementById("btn1").innerHTML += '<div class="button-inner center"></div>'
-  document.getElementById("btn2").innerHTML = (data.btn2 == 1) ? "on" : "off"
-  document.getElementById("btn2").innerHTML += '<div class="button-inner center"></div>'
+  let data
+  if (event.data instanceof ArrayBuffer) {
+    if (!decodeBinaryState(event.data, boardState)) return
+    data = boardState
+  } else {
+    data = JSON.parse(event.data)
+    if (data.error) {
+      console.log(data.error)
+      return
+    }
+    // respuesta de un lote sin errores
+    if (data.ack !== undefined) return
+    // evento de un botón, llega en el momento (data.us: micros() del flanco)
+    if (data.evt == 'btn') {
+      boardState[`btn${data.btn}`] = data.pressed
+      setButton(data.btn, data.pressed)
+      return
+    }
+  }
+  setButton(1, data.btn1)
+  setButton(2, data.btn2)
   //document.getElementById("rgb").style.backgroundColor = data.rgb
-  document.getElementById("rgb").jscolor.setPreviewElementBg(`${data.rgb}`)
+  showRGB(data)
   //document.getElementById("ldr").textContent = data.ldr
   document.getElementById("ldr").style.backgroundColor = `rgb(${data.ldr / 4},${data.ldr / 4},${data.ldr / 4})`
   setVisibility('.lcd', data.lcd_connected);
@@ -104,8 +238,8 @@ document.getElementById('submit-prompt').addEventListener('click', () => {
   const input1 = document.getElementById('input1').value.padEnd(16, ' ').slice(0, 16);
   const input2 = document.getElementById('input2').value.padEnd(16, ' ').slice(0, 16);
 
-  websocket.send(`lcd=0${input1}`);
-  websocket.send(`lcd=1${input2}`);
+  // Ambas filas en un solo mensaje (lote), con una única respuesta
+  websocket.send(`bat\nlcd=0${input1}\nlcd=1${input2}`);
 
   // Ocultar el prompt después de obtener los valores
   document.getElementById('custom-prompt').classList.add('hidden');
@@ -115,5 +249,3 @@ document.getElementById('cancel-prompt').addEventListener('click', () => {
   // Solo oculta el prompt sin hacer nada
   document.getElementById('custom-prompt').classList.add('hidden');
 });
-
-setInterval(getData, 50)
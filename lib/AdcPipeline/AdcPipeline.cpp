@@ -0,0 +1,147 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file AdcPipeline.cpp
+ * @brief Sobremuestreo y filtrado de un canal del ADC. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "AdcPipeline.h"
+
+#include <string.h>
+
+const char *const ADC_FILTER_NAMES[ADC_FILTER_COUNT]{"none", "iir", "median"};
+
+// Raíz cuadrada entera (redondeada hacia abajo)
+static uint32_t isqrt(uint32_t x) {
+  uint32_t root = 0, bit = 1UL << 30;
+  while (bit > x) bit >>= 2;
+  while (bit) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+AdcPipeline::AdcPipeline(uint8_t oversample, AdcFilter filter, uint8_t param)
+    : _oversample{oversample < 1                    ? uint8_t(1)
+                  : oversample > ADC_OVERSAMPLE_MAX ? uint8_t(ADC_OVERSAMPLE_MAX)
+                                                    : oversample},
+      _filter{ADC_FILTER_NONE}, _param{0} {
+  this->configure(filter, param);
+}
+
+/**
+ * @brief Cambia el filtro, se reinicia con el próximo bloque
+ *
+ * @param filter el filtro
+ * @param param corrimiento del IIR (1 a ADC_IIR_SHIFT_MAX) o largo de la
+ * ventana de la mediana (impar, 3 a ADC_MEDIAN_MAX); se ignora en NONE
+ * @return false si los parámetros no son válidos (no se cambia)
+ */
+bool AdcPipeline::configure(AdcFilter filter, uint8_t param) {
+  switch (filter) {
+  case ADC_FILTER_NONE: param = 0; break;
+  case ADC_FILTER_IIR:
+    if (param < 1 or param > ADC_IIR_SHIFT_MAX) return false;
+    break;
+  case ADC_FILTER_MEDIAN:
+    if (param < 3 or param > ADC_MEDIAN_MAX or param % 2 == 0) return false;
+    break;
+  default: return false;
+  }
+  _filter = filter;
+  _param = param;
+  _window_len = _window_pos = 0;
+  _blocks = 0;
+  return true;
+}
+
+/**
+ * @brief Agrega una muestra cruda
+ *
+ * @param sample lectura del ADC
+ * @return true si se completó un bloque (hay un nuevo valor filtrado)
+ */
+bool AdcPipeline::add(uint16_t sample) {
+  _raw = sample;
+  _sum += sample;
+  _sum_sq += uint32_t(sample) * sample;
+  if (++_n < _oversample) return false;
+
+  _decimated16 = (_sum * 16 + _n / 2) / _n;
+  // varianza * 256 = (n * sum_sq - sum^2) * 256 / n^2, desvío en cuentas * 16
+  uint64_t spread = uint64_t(_n) * _sum_sq - uint64_t(_sum) * _sum;
+  uint16_t std16 = isqrt(uint32_t(spread * 256 / (uint32_t(_n) * _n)));
+  _noise16 = _blocks == 0 ? std16 : _noise16 + (int32_t(std16) - _noise16) / 8;
+  _filtered16 = this->filter(_decimated16);
+  _blocks++;
+  _n = 0;
+  _sum = _sum_sq = 0;
+  return true;
+}
+
+uint16_t AdcPipeline::filter(uint16_t decimated16) {
+  switch (_filter) {
+  case ADC_FILTER_IIR: {
+    if (_blocks == 0) return decimated16;
+    int32_t y = _filtered16;
+    // redondeo al más cercano para que converja al valor de entrada
+    int32_t step = int32_t(decimated16) - y;
+    step = (step + (step < 0 ? -1 : 1) * (1 << (_param - 1))) / (1 << _param);
+    return y + step;
+  }
+  case ADC_FILTER_MEDIAN: {
+    _window[_window_pos] = decimated16;
+    _window_pos = (_window_pos + 1) % _param;
+    if (_window_len < _param) _window_len++;
+    uint16_t sorted[ADC_MEDIAN_MAX];
+    memcpy(sorted, _window, _window_len * sizeof(sorted[0]));
+    for (uint8_t i = 1; i < _window_len; i++) {
+      uint16_t v = sorted[i];
+      uint8_t j = i;
+      for (; j > 0 and sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+      sorted[j] = v;
+    }
+    return sorted[_window_len / 2];
+  }
+  default: return decimated16;
+  }
+}
+
+/**
+ * @brief Busca un filtro por nombre
+ *
+ * @return AdcFilter ADC_FILTER_COUNT si no existe
+ */
+AdcFilter AdcPipeline::lookup(const char *name, size_t len) {
+  for (uint8_t f = 0; f < ADC_FILTER_COUNT; f++) {
+    if (strlen(ADC_FILTER_NAMES[f]) == len and
+        not strncmp(ADC_FILTER_NAMES[f], name, len)) {
+      return AdcFilter(f);
+    }
+  }
+  return ADC_FILTER_COUNT;
+}
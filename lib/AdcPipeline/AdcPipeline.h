@@ -0,0 +1,105 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file AdcPipeline.h
+ * @brief Sobremuestreo y filtrado de un canal del ADC. Header file.
+ * @version 0.1
+ *
+ * Las muestras crudas se agrupan en bloques de oversample muestras (tomadas
+ * espaciadas a lo largo del período de reporte); cada bloque se diezma a su
+ * media, con 4 bits fraccionarios, y esa media pasa por un filtro IIR de
+ * primer orden o de mediana. La desviación estándar dentro de cada bloque
+ * (suavizada) es la estimación del ruido.
+ *
+ * Los valores con sufijo 16 están en punto fijo: cuentas del ADC * 16.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __ADCPIPELINE_H__
+#define __ADCPIPELINE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Máximo de muestras por bloque y de bloques en la ventana de la mediana
+#define ADC_OVERSAMPLE_MAX 64
+#define ADC_MEDIAN_MAX 7
+// Máximo corrimiento del IIR (alfa = 1 / 2^shift)
+#define ADC_IIR_SHIFT_MAX 6
+
+/**
+ * @brief Filtros sobre los valores diezmados
+ *
+ * NONE: la media de cada bloque tal cual.
+ * IIR: y += (x - y) / 2^param.
+ * MEDIAN: mediana de los últimos param bloques (impar).
+ */
+enum AdcFilter : uint8_t {
+  ADC_FILTER_NONE,
+  ADC_FILTER_IIR,
+  ADC_FILTER_MEDIAN,
+  ADC_FILTER_COUNT
+};
+
+// Nombres de los filtros (en el orden de AdcFilter)
+extern const char *const ADC_FILTER_NAMES[ADC_FILTER_COUNT];
+
+/**
+ * @brief Canal del ADC sobremuestreado y filtrado
+ *
+ */
+class AdcPipeline {
+private:
+  uint8_t _oversample;
+  AdcFilter _filter;
+  uint8_t _param;
+  // bloque en curso
+  uint8_t _n = 0;
+  uint32_t _sum = 0;
+  uint32_t _sum_sq = 0;
+  // resultados
+  uint16_t _raw = 0;
+  uint16_t _decimated16 = 0;
+  uint16_t _filtered16 = 0;
+  uint16_t _noise16 = 0;
+  uint32_t _blocks = 0;
+  // ventana de la mediana
+  uint16_t _window[ADC_MEDIAN_MAX]{};
+  uint8_t _window_len = 0;
+  uint8_t _window_pos = 0;
+  uint16_t filter(uint16_t decimated16);
+
+public:
+  bool add(uint16_t sample);
+  bool configure(AdcFilter filter, uint8_t param);
+  uint16_t raw() const { return _raw; }
+  uint16_t value() const { return (_filtered16 + 8) >> 4; }
+  uint16_t decimated16() const { return _decimated16; }
+  uint16_t filtered16() const { return _filtered16; }
+  uint16_t noise16() const { return _noise16; }
+  uint32_t blocks() const { return _blocks; }
+  uint8_t oversample() const { return _oversample; }
+  AdcFilter filter() const { return _filter; }
+  uint8_t param() const { return _param; }
+  static AdcFilter lookup(const char *name, size_t len);
+
+  AdcPipeline(uint8_t oversample, AdcFilter filter, uint8_t param);
+};
+
+#endif // __ADCPIPELINE_H__
@@ -0,0 +1,208 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file BoardState.cpp
+ * @brief Foto del estado de la placa y su serialización. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "BoardState.h"
+
+BufferWriter::BufferWriter(char *buf, size_t cap) : _buf{buf}, _cap{cap} {
+  if (_cap > 0) _buf[0] = '\0';
+}
+
+void BufferWriter::put(char c) {
+  if (_overflow or _len + 1 >= _cap) {
+    _overflow = true;
+    return;
+  }
+  _buf[_len++] = c;
+  _buf[_len] = '\0';
+}
+
+void BufferWriter::put(const char *str) {
+  while (*str) put(*str++);
+}
+
+void BufferWriter::putEscaped(const char *str) {
+  for (; *str; str++) {
+    if (*str == '"' or *str == '\\') put('\\');
+    put(*str);
+  }
+}
+
+void BufferWriter::putUInt(uint32_t value) {
+  char digits[10];
+  uint8_t n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (n) put(digits[--n]);
+}
+
+void BufferWriter::putInt(int32_t value) {
+  if (value < 0) {
+    put('-');
+    putUInt(-static_cast<uint32_t>(value));
+  } else {
+    putUInt(value);
+  }
+}
+
+void BufferWriter::putHex(uint32_t value, uint8_t digits) {
+  while (digits) {
+    uint8_t nibble = (value >> (4 * --digits)) & 0xF;
+    put(nibble < 10 ? '0' + nibble : 'A' + nibble - 10);
+  }
+}
+
+void BufferWriter::putFixed2(float value) {
+  // Mismo formato que String(float): dos decimales
+  if (value < 0) {
+    put('-');
+    value = -value;
+  }
+  uint32_t cents = static_cast<uint32_t>(value * 100.0f + 0.5f);
+  putUInt(cents / 100);
+  put('.');
+  put('0' + (cents / 10) % 10);
+  put('0' + cents % 10);
+}
+
+void BufferWriter::putBool(bool value) { put(value ? "true" : "false"); }
+
+size_t stateToJson(const BoardState &state, char *buf, size_t cap) {
+  BufferWriter w{buf, cap};
+  w.put("{\"rgb\":\"#");
+  w.putHex(state.rgb, 6);
+  w.put('"');
+  if (state.fx != EFFECT_STATIC and state.fx < EFFECT_COUNT) {
+    w.put(",\"fx\":\"");
+    w.put(EFFECT_NAMES[state.fx]);
+    w.put("\",\"fx_period\":");
+    w.putUInt(state.fx_period);
+  }
+  for (uint8_t i = 0; i < BOARD_BTNS; i++) {
+    w.put(",\"btn");
+    w.putUInt(i + 1);
+    w.put("\":");
+    w.put(state.btns[i] ? '1' : '0');
+  }
+  w.put(",\"ldr\":");
+  w.putUInt(state.ldr);
+  w.put(",\"lcd_connected\":");
+  w.putBool(state.lcd_connected);
+  if (state.lcd_connected) {
+    w.put(",\"lcd1row\":\"");
+    w.putEscaped(state.lcdrows[0]);
+    w.put("\",\"lcd2row\":\"");
+    w.putEscaped(state.lcdrows[1]);
+    w.put('"');
+  }
+  w.put(",\"aht_connected\":");
+  w.putBool(state.aht_connected);
+  if (state.aht_connected) {
+    w.put(",\"tmp\":");
+    w.putFixed2(state.tmp);
+    w.put(",\"hum\":");
+    w.putFixed2(state.hum);
+  }
+  w.put(",\"bh_connected\":");
+  w.putBool(state.bh_connected);
+  if (state.bh_connected) {
+    w.put(",\"lx\":");
+    w.putFixed2(state.lx);
+  }
+  w.put('}');
+  return w.overflow() ? 0 : w.length();
+}
+
+uint8_t stateDiff(const BoardState &a, const BoardState &b) {
+  uint8_t fields = 0;
+  if (a.rgb != b.rgb) fields |= STATE_FIELD_RGB;
+  if (memcmp(a.btns, b.btns, sizeof(a.btns))) fields |= STATE_FIELD_BTNS;
+  if (a.ldr != b.ldr) fields |= STATE_FIELD_LDR;
+  if (a.tmp != b.tmp or a.aht_connected != b.aht_connected)
+    fields |= STATE_FIELD_TMP;
+  if (a.hum != b.hum or a.aht_connected != b.aht_connected)
+    fields |= STATE_FIELD_HUM;
+  if (a.lx != b.lx or a.bh_connected != b.bh_connected) fields |= STATE_FIELD_LX;
+  if (strcmp(a.lcdrows[0], b.lcdrows[0]) or strcmp(a.lcdrows[1], b.lcdrows[1]) or
+      a.lcd_connected != b.lcd_connected)
+    fields |= STATE_FIELD_LCD;
+  if (a.fx != b.fx or a.fx_period != b.fx_period) fields |= STATE_FIELD_FX;
+  return fields;
+}
+
+static uint8_t *putLE(uint8_t *p, uint32_t value, uint8_t bytes) {
+  for (uint8_t i = 0; i < bytes; i++) {
+    *p++ = value & 0xFF;
+    value >>= 8;
+  }
+  return p;
+}
+
+static int32_t quantize(float value) {
+  return static_cast<int32_t>(value * 100.0f + (value < 0 ? -0.5f : 0.5f));
+}
+
+size_t stateToBinary(const BoardState &state, uint8_t fields, uint8_t *buf,
+                     size_t cap) {
+  if (not state.lcd_connected) fields &= ~STATE_FIELD_LCD;
+  if (not state.aht_connected) fields &= ~(STATE_FIELD_TMP | STATE_FIELD_HUM);
+  if (not state.bh_connected) fields &= ~STATE_FIELD_LX;
+  if (cap < STATE_BIN_MAX) return 0;
+
+  uint8_t *p = buf;
+  *p++ = STATE_BIN_VERSION;
+  *p++ = (state.lcd_connected ? 0x01 : 0) | (state.aht_connected ? 0x02 : 0) |
+         (state.bh_connected ? 0x04 : 0);
+  *p++ = fields;
+  if (fields & STATE_FIELD_RGB) {
+    for (uint8_t c = 0; c < 3; c++) *p++ = uint8_t(state.rgb >> (16 - 8 * c));
+  }
+  if (fields & STATE_FIELD_BTNS) {
+    uint8_t bits = 0;
+    for (uint8_t i = 0; i < BOARD_BTNS; i++) {
+      if (state.btns[i]) bits |= 1 << i;
+    }
+    *p++ = bits;
+  }
+  if (fields & STATE_FIELD_LDR) p = putLE(p, state.ldr, 2);
+  if (fields & STATE_FIELD_TMP) p = putLE(p, quantize(state.tmp), 2);
+  if (fields & STATE_FIELD_HUM) p = putLE(p, quantize(state.hum), 2);
+  if (fields & STATE_FIELD_LX) p = putLE(p, quantize(state.lx), 4);
+  if (fields & STATE_FIELD_LCD) {
+    for (uint8_t r = 0; r < 2; r++) {
+      size_t len = strlen(state.lcdrows[r]);
+      for (uint8_t c = 0; c < BOARD_LCD_COLS; c++) {
+        *p++ = c < len ? state.lcdrows[r][c] : ' ';
+      }
+    }
+  }
+  if (fields & STATE_FIELD_FX) {
+    *p++ = state.fx;
+    p = putLE(p, state.fx_period, 4);
+  }
+  return p - buf;
+}
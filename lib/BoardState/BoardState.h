@@ -0,0 +1,166 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file BoardState.h
+ * @brief Foto del estado de la placa y su serialización. Header file.
+ * @version 0.1
+ *
+ * La serialización escribe sobre un buffer de tamaño fijo provisto por quien
+ * llama, sin utilizar memoria dinámica (nada de String).
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __BOARDSTATE_H__
+#define __BOARDSTATE_H__
+
+#include <RgbEffects.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Cantidad de botones de la placa
+#ifndef BOARD_BTNS
+#define BOARD_BTNS 2
+#endif
+// Caracteres por fila del LCD
+#define BOARD_LCD_COLS 16
+
+// Tamaño máximo del JSON del estado (todas las filas del LCD escapadas)
+#define STATE_JSON_MAX 320
+
+/* Protocolo binario (little-endian):
+ *  [0] versión (STATE_BIN_VERSION)
+ *  [1] flags de conexión: bit0 LCD, bit1 AHT10, bit2 BH1750
+ *  [2] máscara de campos presentes (STATE_FIELD_*), en este orden:
+ *      RGB: 3 bytes (R, G, B)
+ *      BTNS: 1 byte, bit i = botón i+1
+ *      LDR: uint16_t
+ *      TMP: int16_t en centésimas de °C
+ *      HUM: uint16_t en centésimas de %
+ *      LX: uint32_t en centésimas de lx
+ *      LCD: 2 filas de 16 chars (rellenadas con espacios)
+ *      FX: 1 byte con el efecto del LED (RgbEffect) y uint32_t con su
+ *          período en ms
+ */
+#define STATE_BIN_VERSION 1
+#define STATE_FIELD_RGB 0x01
+#define STATE_FIELD_BTNS 0x02
+#define STATE_FIELD_LDR 0x04
+#define STATE_FIELD_TMP 0x08
+#define STATE_FIELD_HUM 0x10
+#define STATE_FIELD_LX 0x20
+#define STATE_FIELD_LCD 0x40
+#define STATE_FIELD_FX 0x80
+#define STATE_FIELD_ALL 0xFF
+// Tamaño máximo de una trama binaria (todos los campos presentes)
+#define STATE_BIN_MAX (3 + 3 + 1 + 2 + 2 + 2 + 4 + 2 * BOARD_LCD_COLS + 5)
+
+/**
+ * @brief Foto del estado del hardware, se usa para detectar cambios
+ *
+ * Con un efecto animado en el LED, rgb es el color elegido y no el que se
+ * muestra en cada momento: el estado cambia con el efecto (fx y
+ * fx_period), no con cada paso, y el cliente anima el color.
+ */
+struct BoardState {
+  uint32_t rgb; // 0xRRGGBB
+  uint8_t fx;   // efecto del LED (RgbEffect)
+  uint32_t fx_period;
+  bool btns[BOARD_BTNS];
+  uint16_t ldr;
+  bool lcd_connected;
+  char lcdrows[2][BOARD_LCD_COLS + 1];
+  bool aht_connected;
+  float tmp;
+  float hum;
+  bool bh_connected;
+  float lx;
+
+  bool operator==(const BoardState &o) const {
+    return rgb == o.rgb && fx == o.fx && fx_period == o.fx_period &&
+           !memcmp(btns, o.btns, sizeof(btns)) &&
+           ldr == o.ldr && lcd_connected == o.lcd_connected &&
+           !strcmp(lcdrows[0], o.lcdrows[0]) &&
+           !strcmp(lcdrows[1], o.lcdrows[1]) &&
+           aht_connected == o.aht_connected && tmp == o.tmp &&
+           hum == o.hum && bh_connected == o.bh_connected && lx == o.lx;
+  }
+  bool operator!=(const BoardState &o) const { return !(*this == o); }
+};
+
+/**
+ * @brief Escritor secuencial sobre un buffer de tamaño fijo
+ *
+ * Si el texto no entra en el buffer se marca el desborde y se ignoran las
+ * escrituras siguientes, el buffer siempre queda terminado en '\0'.
+ */
+class BufferWriter {
+private:
+  char *_buf;
+  size_t _cap;
+  size_t _len = 0;
+  bool _overflow = false;
+
+public:
+  BufferWriter(char *buf, size_t cap);
+  void put(char c);
+  void put(const char *str);
+  void putEscaped(const char *str);
+  void putUInt(uint32_t value);
+  void putInt(int32_t value);
+  void putHex(uint32_t value, uint8_t digits);
+  void putFixed2(float value);
+  void putBool(bool value);
+  size_t length() const { return _len; }
+  bool overflow() const { return _overflow; }
+};
+
+/**
+ * @brief Serializa el estado en JSON sobre buf
+ *
+ * @param state estado a serializar
+ * @param buf buffer destino
+ * @param cap tamaño de buf (se recomienda STATE_JSON_MAX)
+ * @return size_t largo del JSON, 0 si no entró en el buffer
+ */
+size_t stateToJson(const BoardState &state, char *buf, size_t cap);
+
+/**
+ * @brief Calcula qué campos cambiaron entre dos estados
+ *
+ * @return uint8_t máscara STATE_FIELD_* con los campos distintos
+ */
+uint8_t stateDiff(const BoardState &a, const BoardState &b);
+
+/**
+ * @brief Serializa en el protocolo binario solo los campos de fields
+ *
+ * Los campos de sensores desconectados se omiten aunque estén en fields.
+ *
+ * @param state estado a serializar
+ * @param fields máscara STATE_FIELD_* de los campos a incluir
+ * @param buf buffer destino
+ * @param cap tamaño de buf (se recomienda STATE_BIN_MAX)
+ * @return size_t largo de la trama, 0 si no entró en el buffer
+ */
+size_t stateToBinary(const BoardState &state, uint8_t fields, uint8_t *buf,
+                     size_t cap);
+
+#endif // __BOARDSTATE_H__
@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file ButtonEvents.cpp
+ * @brief Antirrebote de botones a partir de flancos con marca de tiempo. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "ButtonEvents.h"
+
+EdgeDebouncer::EdgeDebouncer(uint8_t buttons, uint32_t window_us)
+    : _n{buttons <= BUTTON_MAX ? buttons : uint8_t(BUTTON_MAX)},
+      _window_us{window_us} {}
+
+/**
+ * @brief Fija el nivel confirmado de un botón (al arrancar), descartando
+ * los flancos sin confirmar
+ *
+ */
+void EdgeDebouncer::reset(uint8_t button, uint8_t level) {
+  if (button >= _n) return;
+  Channel &c = _channels[button];
+  c.stable = c.level = level;
+  c.settling = false;
+}
+
+/**
+ * @brief Registra un flanco
+ *
+ * El primero de una ráfaga abre la ventana, los siguientes son rebotes que
+ * la extienden hasta que el pin quede quieto.
+ *
+ * @param edge el flanco (del botón edge.button)
+ */
+void EdgeDebouncer::edge(const ButtonEdge &edge) {
+  if (edge.button >= _n) return;
+  Channel &c = _channels[edge.button];
+  if (c.settling) {
+    _bounces++;
+  } else {
+    c.settling = true;
+    c.first_us = edge.us;
+  }
+  c.last_us = edge.us;
+  c.level = edge.level;
+}
+
+/**
+ * @brief Confirma los botones que quedaron quietos durante la ventana
+ *
+ * Se llama hasta que devuelva false, cada llamada informa a lo sumo un
+ * cambio. Una ráfaga que termina en el mismo nivel (un pico de ruido) no
+ * produce cambios.
+ *
+ * @param now_us micros() actual
+ * @param change el cambio confirmado, con la marca de tiempo del primer
+ * flanco de la ráfaga
+ * @return true si se confirmó un cambio
+ */
+bool EdgeDebouncer::poll(uint32_t now_us, ButtonEdge &change) {
+  for (uint8_t b = 0; b < _n; b++) {
+    Channel &c = _channels[b];
+    if (not c.settling or now_us - c.last_us < _window_us) continue;
+    c.settling = false;
+    if (c.level == c.stable) continue;
+    c.stable = c.level;
+    change.us = c.first_us;
+    change.button = b;
+    change.level = c.level;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Indica si hay flancos esperando que termine su ventana
+ *
+ */
+bool EdgeDebouncer::settling() const {
+  for (uint8_t b = 0; b < _n; b++) {
+    if (_channels[b].settling) return true;
+  }
+  return false;
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file ButtonEvents.h
+ * @brief Antirrebote de botones a partir de flancos con marca de tiempo. Header file.
+ * @version 0.1
+ *
+ * Una interrupción por cambio de nivel registra cada flanco (nivel y
+ * micros()) en una cola y fuera de la interrupción EdgeDebouncer los filtra:
+ * un cambio se confirma cuando el pin queda quieto durante la ventana de
+ * antirrebote, y se informa con la marca de tiempo del primer flanco de la
+ * ráfaga (el momento real en que se presionó o soltó).
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __BUTTONEVENTS_H__
+#define __BUTTONEVENTS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Cantidad máxima de botones
+#ifndef BUTTON_MAX
+#define BUTTON_MAX 8
+#endif
+
+/**
+ * @brief Un flanco de un botón (o un cambio confirmado)
+ *
+ */
+struct ButtonEdge {
+  uint32_t us;    // micros() del flanco
+  uint8_t button; // número de botón
+  uint8_t level;  // nivel del pin después del flanco (HIGH/LOW)
+};
+
+/**
+ * @brief Antirrebote de hasta BUTTON_MAX botones a partir de sus flancos
+ *
+ * Se usa desde un solo contexto (no desde la interrupción): edge() con cada
+ * flanco que sale de la cola y poll() para obtener los cambios confirmados.
+ * Un flanco de más (por ejemplo para resincronizar con el nivel actual del
+ * pin) no produce cambios si el nivel no cambió.
+ */
+class EdgeDebouncer {
+private:
+  struct Channel {
+    uint8_t stable;    // último nivel confirmado
+    uint8_t level;     // nivel del último flanco
+    bool settling;     // hay flancos sin confirmar
+    uint32_t first_us; // primer flanco de la ráfaga
+    uint32_t last_us;  // último flanco de la ráfaga
+  };
+  Channel _channels[BUTTON_MAX]{};
+  uint8_t _n;
+  uint32_t _window_us;
+  uint32_t _bounces = 0;
+
+public:
+  void reset(uint8_t button, uint8_t level);
+  void edge(const ButtonEdge &edge);
+  bool poll(uint32_t now_us, ButtonEdge &change);
+  bool settling() const;
+  uint8_t stable(uint8_t button) const { return _channels[button].stable; }
+  uint32_t bounces() const { return _bounces; }
+
+  EdgeDebouncer(uint8_t buttons, uint32_t window_us);
+};
+
+#endif // __BUTTONEVENTS_H__
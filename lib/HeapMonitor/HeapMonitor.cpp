@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file HeapMonitor.cpp
+ * @brief Seguimiento del heap (libre, bloque máximo y fragmentación). Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "HeapMonitor.h"
+
+// Se queda con el peor valor de cada campo
+static void worst(HeapSample &acc, const HeapSample &s) {
+  if (s.free < acc.free) acc.free = s.free;
+  if (s.max_block < acc.max_block) acc.max_block = s.max_block;
+  if (s.frag > acc.frag) acc.frag = s.frag;
+}
+
+HeapMonitor::HeapMonitor(uint16_t group) : _group{group < 1 ? uint16_t(1) : group} {}
+
+/**
+ * @brief Agrega una muestra
+ *
+ * Cada group muestras se cierra un grupo y se guarda en el historial (si
+ * está lleno se descarta el más viejo).
+ *
+ * @param free bytes libres
+ * @param max_block bytes del bloque libre más grande
+ * @param frag fragmentación en %
+ */
+void HeapMonitor::add(uint32_t free, uint32_t max_block, uint8_t frag) {
+  _last = HeapSample{free, max_block, frag};
+  if (_samples == 0) _low = _last;
+  worst(_low, _last);
+  if (_current_n == 0) _current = _last;
+  worst(_current, _last);
+  _samples++;
+  if (++_current_n < _group) return;
+  _history[_history_pos] = _current;
+  _history_pos = (_history_pos + 1) % HEAP_HISTORY_LEN;
+  if (_history_len < HEAP_HISTORY_LEN) _history_len++;
+  _current_n = 0;
+}
+
+/**
+ * @brief Un grupo del historial
+ *
+ * @param i 0 es el más viejo, historyLen() - 1 el más nuevo
+ * @return const HeapSample& el peor valor de cada campo en el grupo
+ */
+const HeapSample &HeapMonitor::history(uint8_t i) const {
+  uint8_t oldest = (_history_pos + HEAP_HISTORY_LEN - _history_len) % HEAP_HISTORY_LEN;
+  return _history[(oldest + i) % HEAP_HISTORY_LEN];
+}
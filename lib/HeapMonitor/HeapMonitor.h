@@ -0,0 +1,83 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file HeapMonitor.h
+ * @brief Seguimiento del heap (libre, bloque máximo y fragmentación). Header file.
+ * @version 0.1
+ *
+ * Se le pasan muestras periódicas (ESP.getFreeHeap(),
+ * ESP.getMaxFreeBlockSize() y ESP.getHeapFragmentation()) y guarda la
+ * última, los mínimos desde el arranque y un historial con el peor valor de
+ * cada grupo de muestras, para ver la tendencia en el tiempo.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __HEAPMONITOR_H__
+#define __HEAPMONITOR_H__
+
+#include <stdint.h>
+
+// Cantidad de grupos que se conservan en el historial
+#ifndef HEAP_HISTORY_LEN
+#define HEAP_HISTORY_LEN 60
+#endif
+
+/**
+ * @brief Una muestra del heap
+ *
+ * free y max_block en bytes, frag en % (0 todo contiguo).
+ */
+struct HeapSample {
+  uint32_t free;
+  uint32_t max_block;
+  uint8_t frag;
+};
+
+/**
+ * @brief Última muestra, mínimos y el historial del heap
+ *
+ * En low() y en el historial cada campo es el peor visto: el menor libre,
+ * el menor bloque máximo y la mayor fragmentación (pueden venir de muestras
+ * distintas).
+ */
+class HeapMonitor {
+private:
+  uint16_t _group;
+  HeapSample _last{};
+  HeapSample _low{};
+  HeapSample _current{}; // grupo en curso
+  uint16_t _current_n = 0;
+  HeapSample _history[HEAP_HISTORY_LEN]{};
+  uint8_t _history_len = 0;
+  uint8_t _history_pos = 0; // próximo lugar a escribir
+  uint32_t _samples = 0;
+
+public:
+  void add(uint32_t free, uint32_t max_block, uint8_t frag);
+  const HeapSample &last() const { return _last; }
+  const HeapSample &low() const { return _low; }
+  uint32_t samples() const { return _samples; }
+  uint16_t group() const { return _group; }
+  uint8_t historyLen() const { return _history_len; }
+  const HeapSample &history(uint8_t i) const;
+
+  HeapMonitor(uint16_t group);
+};
+
+#endif // __HEAPMONITOR_H__
@@ -0,0 +1,172 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file I2CBusManager.cpp
+ * @brief Detección de dispositivos I2C conectados en caliente. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "I2CBusManager.h"
+
+I2CBusManager::I2CBusManager(PeriodicTaskManager &tasker,
+                             const I2CDriver *drivers, uint8_t n_drivers,
+                             TwoWire &wire)
+    : _tasker{tasker}, _wire{wire}, _drivers{drivers}, _n_drivers{n_drivers} {}
+
+/**
+ * @brief Registra las tareas de lectura (pausadas) y sondea el bus
+ *
+ * @return false si la tabla es más grande que I2C_MAX_DRIVERS o no hay
+ * lugar para las tareas de lectura
+ */
+bool I2CBusManager::begin() {
+  if (_n_drivers > I2C_MAX_DRIVERS) return false;
+  for (uint8_t i = 0; i < _n_drivers; i++) {
+    const I2CDriver &d = _drivers[i];
+    if (d.read == nullptr) continue;
+    _read_task[i] = _tasker.add(d.read, d.name, d.read_ms, d.policy);
+    if (not _read_task[i].valid()) return false;
+    _tasker.pause(_read_task[i]);
+  }
+  _probe_now = true;
+  this->refresh();
+  return true;
+}
+
+/**
+ * @brief Sondea el bus si venció el intervalo actual
+ *
+ * Se llama periódicamente (cada I2C_PROBE_MIN_MS), pero solo genera tráfico
+ * en el bus cuando corresponde según el intervalo con backoff.
+ */
+void I2CBusManager::refresh() {
+  uint32_t now = millis();
+  if (not _probe_now and now - _last_probe_ms < _interval_ms) return;
+  _probe_now = false;
+  _last_probe_ms = now;
+  bool changed = false;
+  for (uint8_t i = 0; i < _n_drivers; i++) {
+    if (this->probeDriver(i)) changed = true;
+  }
+  if (changed) {
+    _interval_ms = I2C_PROBE_MIN_MS;
+  } else if (_interval_ms < I2C_PROBE_MAX_MS) {
+    _interval_ms *= 2;
+    if (_interval_ms > I2C_PROBE_MAX_MS) _interval_ms = I2C_PROBE_MAX_MS;
+  }
+}
+
+/**
+ * @brief Fuerza un sondeo en la próxima llamada a refresh() y reinicia el
+ * backoff (por ejemplo cuando falla una lectura)
+ *
+ */
+void I2CBusManager::reprobe() {
+  _probe_now = true;
+  _interval_ms = I2C_PROBE_MIN_MS;
+}
+
+/**
+ * @brief Da por desconectado un dispositivo sin esperar al próximo sondeo
+ *
+ * @param driver índice en la tabla
+ */
+void I2CBusManager::lost(uint8_t driver) {
+  if (this->connected(driver)) this->disconnect(driver);
+  this->reprobe();
+}
+
+bool I2CBusManager::connected(uint8_t driver) const {
+  return driver < _n_drivers and _address[driver] != 0;
+}
+
+uint8_t I2CBusManager::address(uint8_t driver) const {
+  return driver < _n_drivers ? _address[driver] : 0;
+}
+
+TaskHandle I2CBusManager::readTask(uint8_t driver) const {
+  return driver < _n_drivers ? _read_task[driver] : TaskHandle{};
+}
+
+/**
+ * @brief Sondeos del bus hechos para un driver
+ *
+ * @param driver índice en la tabla
+ * @return uint32_t cantidad de transacciones de sondeo
+ */
+uint32_t I2CBusManager::probes(uint8_t driver) const {
+  return driver < _n_drivers ? _driver_probes[driver] : 0;
+}
+
+/**
+ * @brief Veces que se dio por desconectado un driver
+ *
+ * @param driver índice en la tabla
+ * @return uint32_t desconexiones (por sondeo o por lost())
+ */
+uint32_t I2CBusManager::disconnects(uint8_t driver) const {
+  return driver < _n_drivers ? _disconnects[driver] : 0;
+}
+
+bool I2CBusManager::probe(uint8_t driver, uint8_t address) {
+  _probes++;
+  _driver_probes[driver]++;
+  _wire.beginTransmission(address);
+  return _wire.endTransmission() == 0;
+}
+
+/**
+ * @brief Verifica un driver: si está conectado solo sondea su dirección,
+ * sino busca entre las posibles y lo inicializa
+ *
+ * @return true si cambió su estado (se conectó o se desconectó)
+ */
+bool I2CBusManager::probeDriver(uint8_t driver) {
+  bool changed = false;
+  if (_address[driver] != 0) {
+    if (this->probe(driver, _address[driver])) return false;
+    this->disconnect(driver);
+    changed = true;
+  }
+  const I2CDriver &d = _drivers[driver];
+  for (uint8_t a = 0; a < d.n_addresses; a++) {
+    if (this->probe(driver, d.addresses[a])) {
+      if (d.init(d.addresses[a])) {
+        this->connect(driver, d.addresses[a]);
+        changed = true;
+      }
+      break;
+    }
+  }
+  return changed;
+}
+
+void I2CBusManager::connect(uint8_t driver, uint8_t address) {
+  _address[driver] = address;
+  if (_read_task[driver].valid()) _tasker.unpause(_read_task[driver]);
+}
+
+void I2CBusManager::disconnect(uint8_t driver) {
+  if (_read_task[driver].valid()) _tasker.pause(_read_task[driver]);
+  if (_drivers[driver].teardown != nullptr) _drivers[driver].teardown();
+  _address[driver] = 0;
+  _disconnects[driver]++;
+}
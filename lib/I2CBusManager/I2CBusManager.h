@@ -0,0 +1,109 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file I2CBusManager.h
+ * @brief Detección de dispositivos I2C conectados en caliente. Header file.
+ * @version 0.1
+ *
+ * Una única tarea sondea el bus según una tabla de drivers (direcciones
+ * posibles, inicialización, tarea de lectura y liberación). El intervalo
+ * entre sondeos se duplica mientras no hay cambios (hasta I2C_PROBE_MAX_MS)
+ * y vuelve al mínimo cuando un dispositivo se conecta o desconecta.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __I2CBUSMANAGER_H__
+#define __I2CBUSMANAGER_H__
+
+#include <Arduino.h>
+#include <PeriodicTaskManager.h>
+#include <Wire.h>
+
+// Cantidad máxima de drivers en la tabla
+#ifndef I2C_MAX_DRIVERS
+#define I2C_MAX_DRIVERS 8
+#endif
+// Intervalo mínimo entre sondeos (ms), también es el período de la tarea
+#ifndef I2C_PROBE_MIN_MS
+#define I2C_PROBE_MIN_MS 250
+#endif
+// Intervalo máximo entre sondeos (ms) con la topología estable
+#ifndef I2C_PROBE_MAX_MS
+#define I2C_PROBE_MAX_MS 8000
+#endif
+
+/**
+ * @brief Entrada de la tabla de drivers
+ *
+ */
+struct I2CDriver {
+  const char *name;          // nombre (también de la tarea de lectura)
+  const uint8_t *addresses;  // direcciones posibles, en orden de preferencia
+  uint8_t n_addresses;
+  bool (*init)(uint8_t address); // inicializa, true si quedó funcionando
+  void (*teardown)();            // libera lo que se haya inicializado
+  void (*read)(uint8_t id);      // tarea de lectura (nullptr si no tiene)
+  uint32_t read_ms;              // período de la tarea de lectura
+  OverrunPolicy policy;          // política de la tarea de lectura
+};
+
+/**
+ * @brief Administra los dispositivos del bus I2C a partir de una tabla
+ *
+ * Las tareas de lectura se registran en el PeriodicTaskManager pausadas y
+ * solo se reanudan mientras el dispositivo está conectado.
+ */
+class I2CBusManager {
+private:
+  PeriodicTaskManager &_tasker;
+  TwoWire &_wire;
+  const I2CDriver *_drivers;
+  uint8_t _n_drivers;
+  uint8_t _address[I2C_MAX_DRIVERS]{}; // dirección conectada, 0 si no está
+  TaskHandle _read_task[I2C_MAX_DRIVERS]{};
+  uint32_t _interval_ms = I2C_PROBE_MIN_MS;
+  uint32_t _last_probe_ms = 0;
+  bool _probe_now = true;
+  uint32_t _probes = 0;
+  uint32_t _driver_probes[I2C_MAX_DRIVERS]{};
+  uint32_t _disconnects[I2C_MAX_DRIVERS]{};
+  bool probe(uint8_t driver, uint8_t address);
+  bool probeDriver(uint8_t driver);
+  void connect(uint8_t driver, uint8_t address);
+  void disconnect(uint8_t driver);
+
+public:
+  bool begin();
+  void refresh();
+  void reprobe();
+  void lost(uint8_t driver);
+  bool connected(uint8_t driver) const;
+  uint8_t address(uint8_t driver) const;
+  TaskHandle readTask(uint8_t driver) const;
+  uint32_t interval() const { return _interval_ms; }
+  uint32_t probes() const { return _probes; }
+  uint32_t probes(uint8_t driver) const;
+  uint32_t disconnects(uint8_t driver) const;
+
+  I2CBusManager(PeriodicTaskManager &tasker, const I2CDriver *drivers,
+                uint8_t n_drivers, TwoWire &wire = Wire);
+};
+
+#endif // __I2CBUSMANAGER_H__
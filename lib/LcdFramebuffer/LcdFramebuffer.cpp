@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file LcdFramebuffer.cpp
+ * @brief Framebuffer con copia sombra para un LCD de caracteres. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "LcdFramebuffer.h"
+
+LcdFramebuffer::LcdFramebuffer() {
+  this->clear();
+  this->reset();
+}
+
+/**
+ * @brief Escribe una fila completa, rellenando con espacios
+ *
+ * @param row fila (0 a LCD_FB_ROWS - 1)
+ * @param text texto (no necesita terminar en '\0')
+ * @param len largo de text, se recorta a LCD_FB_COLS
+ * @return false si la fila no existe
+ */
+bool LcdFramebuffer::setRow(uint8_t row, const char *text, size_t len) {
+  if (row >= LCD_FB_ROWS) return false;
+  if (len > LCD_FB_COLS) len = LCD_FB_COLS;
+  memcpy(_target[row], text, len);
+  memset(_target[row] + len, ' ', LCD_FB_COLS - len);
+  return true;
+}
+
+/**
+ * @brief Borra el contenido a mostrar (todo espacios)
+ *
+ */
+void LcdFramebuffer::clear() { memset(_target, ' ', sizeof(_target)); }
+
+/**
+ * @brief Indica que el display se acaba de inicializar: está en blanco y
+ * con el cursor al principio, en el próximo render() se redibuja lo que no
+ * sean espacios
+ *
+ */
+void LcdFramebuffer::reset() {
+  memset(_shadow, ' ', sizeof(_shadow));
+  _cursor_known = true;
+  _cursor_row = 0;
+  _cursor_col = 0;
+}
+
+/**
+ * @brief Indica que no se sabe qué muestra el display (por ejemplo falló
+ * una escritura): en el próximo render() se redibuja todo
+ *
+ * La copia sombra se llena con '\0', que los textos no usan (es el primer
+ * caracter definible del HD44780).
+ */
+void LcdFramebuffer::invalidate() {
+  memset(_shadow, 0, sizeof(_shadow));
+  _cursor_known = false;
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file LcdFramebuffer.h
+ * @brief Framebuffer con copia sombra para un LCD de caracteres. Header file.
+ * @version 0.1
+ *
+ * Los textos se escriben en el framebuffer (sin tocar el bus) y render()
+ * envía al display solo las celdas que difieren de lo que ya muestra (la
+ * copia sombra), con la menor cantidad de movimientos del cursor y una
+ * cantidad acotada de celdas por llamada. Si el display no confirma una
+ * escritura (write() devuelve 0) se deja de confiar en la copia sombra.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __LCDFRAMEBUFFER_H__
+#define __LCDFRAMEBUFFER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef LCD_FB_COLS
+#define LCD_FB_COLS 16
+#endif
+#ifndef LCD_FB_ROWS
+#define LCD_FB_ROWS 2
+#endif
+
+/**
+ * @brief Framebuffer de LCD_FB_ROWS x LCD_FB_COLS caracteres
+ *
+ * El display (Display) solo necesita setCursor(col, row) y write(char),
+ * como LiquidCrystal_I2C; write() devuelve 0 si falló. Se asume que el
+ * cursor avanza solo una columna por cada caracter escrito, como en el
+ * HD44780.
+ */
+class LcdFramebuffer {
+private:
+  char _target[LCD_FB_ROWS][LCD_FB_COLS];
+  char _shadow[LCD_FB_ROWS][LCD_FB_COLS];
+  uint8_t _cursor_row = 0;
+  uint8_t _cursor_col = 0;
+  bool _cursor_known = false;
+  uint32_t _cells = 0;
+  uint32_t _moves = 0;
+  uint32_t _errors = 0;
+
+public:
+  bool setRow(uint8_t row, const char *text, size_t len);
+  void clear();
+  void reset();
+  void invalidate();
+  bool dirty() const { return memcmp(_target, _shadow, sizeof(_target)) != 0; }
+  char at(uint8_t row, uint8_t col) const { return _target[row][col]; }
+  uint32_t cells() const { return _cells; }
+  uint32_t moves() const { return _moves; }
+  uint32_t errors() const { return _errors; }
+
+  /**
+   * @brief Envía al display las celdas que cambiaron
+   *
+   * Recorre las celdas en orden; si entre dos celdas distintas en la misma
+   * fila hay una sola igual, se reescribe esa en vez de mover el cursor
+   * (cuesta lo mismo y deja el cursor en su lugar).
+   *
+   * @param display destino (setCursor(col, row) y write(char))
+   * @param max_cells cantidad máxima de celdas a escribir en esta llamada
+   * @return uint8_t celdas escritas (0 si no había cambios). Si una
+   * escritura falla se corta ahí, se suma a errors() y se invalida la
+   * copia sombra.
+   */
+  template <typename Display>
+  uint8_t render(Display &display, uint8_t max_cells) {
+    uint8_t written = 0;
+    for (uint8_t r = 0; r < LCD_FB_ROWS; r++) {
+      for (uint8_t c = 0; c < LCD_FB_COLS; c++) {
+        if (_target[r][c] == _shadow[r][c]) continue;
+        if (written >= max_cells) return written;
+        bool at_cursor = _cursor_known and _cursor_row == r;
+        if (at_cursor and _cursor_col + 1 == c and written + 1 < max_cells) {
+          if (not this->put(display, r, c - 1)) return this->fail(written);
+          written++;
+        } else if (not at_cursor or _cursor_col != c) {
+          display.setCursor(c, r);
+          _moves++;
+          _cursor_known = true;
+          _cursor_row = r;
+          _cursor_col = c;
+        }
+        if (not this->put(display, r, c)) return this->fail(written);
+        written++;
+      }
+    }
+    return written;
+  }
+
+  LcdFramebuffer();
+
+private:
+  template <typename Display> bool put(Display &display, uint8_t r, uint8_t c) {
+    if (display.write(_target[r][c]) == 0) return false;
+    _shadow[r][c] = _target[r][c];
+    _cells++;
+    // Al pasar la última columna el HD44780 no sigue en la próxima fila
+    if (++_cursor_col >= LCD_FB_COLS) _cursor_known = false;
+    return true;
+  }
+  uint8_t fail(uint8_t written) {
+    _errors++;
+    this->invalidate();
+    return written;
+  }
+};
+
+#endif // __LCDFRAMEBUFFER_H__
@@ -0,0 +1,177 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file Metrics.cpp
+ * @brief Métricas en el formato de texto de Prometheus. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "Metrics.h"
+
+#include <string.h>
+
+void PromWriter::put(const char *s) {
+  while (*s) {
+    if (_len >= _cap) {
+      _fits = false;
+      return;
+    }
+    _buf[_len++] = *s++;
+  }
+}
+
+// Los valores de las etiquetas van entre comillas: se escapan \, " y \n
+void PromWriter::putLabelValue(const char *s) {
+  for (; *s; s++) {
+    char c[3]{*s, '\0', '\0'};
+    if (*s == '\\' or *s == '"') {
+      c[0] = '\\';
+      c[1] = *s;
+    } else if (*s == '\n') {
+      c[0] = '\\';
+      c[1] = 'n';
+    }
+    this->put(c);
+  }
+}
+
+void PromWriter::putUInt(uint64_t value) {
+  char digits[21];
+  char *p = digits + sizeof(digits) - 1;
+  *p = '\0';
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  this->put(p);
+}
+
+// Termina la línea, si no entró se descarta desde start
+bool PromWriter::endLine(size_t start) {
+  this->put("\n");
+  if (_fits) return true;
+  _len = start;
+  _fits = true;
+  return false;
+}
+
+/**
+ * @brief Escribe las líneas # HELP y # TYPE de una familia
+ *
+ * @return false si no entraron (no se escribe ninguna de las dos)
+ */
+bool PromWriter::header(const char *name, const char *type, const char *help) {
+  size_t start = _len;
+  this->put("# HELP ");
+  this->put(name);
+  this->put(" ");
+  this->put(help);
+  this->put("\n# TYPE ");
+  this->put(name);
+  this->put(" ");
+  this->put(type);
+  return this->endLine(start);
+}
+
+/**
+ * @brief Escribe una muestra sin etiquetas: nombre valor
+ *
+ * @return false si no entró
+ */
+bool PromWriter::sample(const char *name, uint64_t value) {
+  size_t start = _len;
+  this->put(name);
+  this->put(" ");
+  this->putUInt(value);
+  return this->endLine(start);
+}
+
+/**
+ * @brief Escribe una muestra con una etiqueta: nombre{label="value"} valor
+ *
+ * @return false si no entró
+ */
+bool PromWriter::sample(const char *name, const char *label,
+                        const char *label_value, uint64_t value) {
+  size_t start = _len;
+  this->put(name);
+  this->put("{");
+  this->put(label);
+  this->put("=\"");
+  this->putLabelValue(label_value);
+  this->put("\"} ");
+  this->putUInt(value);
+  return this->endLine(start);
+}
+
+// Arma en cursor.line la próxima muestra con contenido, false al terminar
+static bool nextLine(const MetricFamily *families, uint8_t n_families,
+                     MetricsCursor &cursor) {
+  while (cursor.family < n_families) {
+    const MetricFamily &f = families[cursor.family];
+    uint8_t n = f.count != nullptr ? f.count() : 1;
+    if (cursor.item > n) {
+      cursor.family++;
+      cursor.item = 0;
+      continue;
+    }
+    PromWriter w{cursor.line, sizeof(cursor.line)};
+    if (cursor.item == 0) {
+      w.header(f.name, f.type, f.help);
+    } else {
+      f.sample(w, f.name, cursor.item - 1);
+    }
+    cursor.item++;
+    cursor.line_len = w.length();
+    cursor.line_pos = 0;
+    if (cursor.line_len > 0) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Escribe lo que entre desde el cursor y lo avanza
+ *
+ * Se llama con el mismo cursor hasta que devuelve 0 (fin de la tabla).
+ * Mientras falte texto siempre escribe algo, aunque len sea chico.
+ *
+ * @param families tabla de familias
+ * @param n_families cantidad de familias
+ * @param cursor por dónde se va, se actualiza
+ * @param buf destino (no se termina en '\0')
+ * @param len tamaño de buf
+ * @return size_t bytes escritos, 0 cuando se terminó la tabla
+ */
+size_t writeMetrics(const MetricFamily *families, uint8_t n_families,
+                    MetricsCursor &cursor, char *buf, size_t len) {
+  size_t written = 0;
+  while (written < len) {
+    if (cursor.line_pos == cursor.line_len and
+        not nextLine(families, n_families, cursor)) {
+      break;
+    }
+    size_t n = cursor.line_len - cursor.line_pos;
+    if (n > len - written) n = len - written;
+    memcpy(buf + written, cursor.line + cursor.line_pos, n);
+    cursor.line_pos += n;
+    written += n;
+  }
+  return written;
+}
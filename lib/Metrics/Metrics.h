@@ -0,0 +1,102 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file Metrics.h
+ * @brief Métricas en el formato de texto de Prometheus. Header file.
+ * @version 0.1
+ *
+ * Las métricas se describen en una tabla de familias (nombre, tipo, ayuda y
+ * una función que escribe cada muestra) y se escriben de a partes en el
+ * buffer que entrega una respuesta HTTP chunked: se arma una muestra por vez
+ * y un cursor recuerda por dónde se iba (incluso a mitad de una línea, si la
+ * parte es más chica). Así no hace falta armar todo el texto en memoria.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largo máximo de una muestra (o del encabezado de una familia), las que no
+// entran se omiten
+#ifndef METRICS_LINE_MAX
+#define METRICS_LINE_MAX 160
+#endif
+
+/**
+ * @brief Escribe líneas del formato de texto de Prometheus en un buffer
+ *
+ * Cada método escribe una línea completa o nada (si no entra, el buffer
+ * queda como estaba y devuelve false).
+ */
+class PromWriter {
+private:
+  char *_buf;
+  size_t _cap;
+  size_t _len = 0;
+  bool _fits = true;
+  void put(const char *s);
+  void putLabelValue(const char *s);
+  void putUInt(uint64_t value);
+  bool endLine(size_t start);
+
+public:
+  bool header(const char *name, const char *type, const char *help);
+  bool sample(const char *name, uint64_t value);
+  bool sample(const char *name, const char *label, const char *label_value,
+              uint64_t value);
+  size_t length() const { return _len; }
+
+  PromWriter(char *buf, size_t cap) : _buf{buf}, _cap{cap} {}
+};
+
+/**
+ * @brief Una familia de métricas de la tabla
+ *
+ * count() es la cantidad de muestras (nullptr si es una sola) y sample()
+ * escribe la muestra i con w.sample(name, ...); si no escribe nada la
+ * muestra se omite.
+ */
+struct MetricFamily {
+  const char *name;
+  const char *type; // "counter" o "gauge"
+  const char *help;
+  uint8_t (*count)();
+  void (*sample)(PromWriter &w, const char *name, uint8_t i);
+};
+
+/**
+ * @brief Por dónde va la escritura de la tabla (empieza con todo en 0)
+ *
+ */
+struct MetricsCursor {
+  uint8_t family;
+  uint8_t item; // 0 es el encabezado, i + 1 la muestra i
+  // muestra armada que todavía no se terminó de enviar
+  char line[METRICS_LINE_MAX];
+  uint8_t line_len;
+  uint8_t line_pos;
+};
+
+size_t writeMetrics(const MetricFamily *families, uint8_t n_families,
+                    MetricsCursor &cursor, char *buf, size_t len);
+
+#endif // __METRICS_H__
@@ -19,10 +19,17 @@
  * @file PeriodicTaskManager.cpp
  * @author Matías S. Ávalos (msavalos@gmail.com)
  * @brief Simple Periodic Tasks Managment. Implementation file.
- * @version 0.2
- * @date 2023-07-04
+ * @version 0.4
+ * @date 2026-10-17
  * 
- * TODO: Escribir alguna descripción piola.
+ * Hasta MAX_TASKS tareas en un arreglo fijo (sin memoria dinámica). Las
+ * activas están en un min-heap por próximo vencimiento: refresh() saca todas
+ * las vencidas y ejecuta cada una a lo sumo una vez por llamada, reagendada
+ * antes de correr para que pueda pausarse, demorarse o eliminarse a sí
+ * misma. Cuando una tarea arranca tarde un período o más se aplica su
+ * OverrunPolicy. Las tareas se referencian con TaskHandle (índice y
+ * generación, O(1)) o por nombre (búsqueda lineal). Con PTM_PROFILING se
+ * miden además los tiempos de ejecución y el retraso de cada tarea.
  * 
  * @copyright Copyright (c) 2022-2023
  * 
@@ -35,39 +42,123 @@ PeriodicTaskManager::PeriodicTaskManager() {
     _tasks[i].task = NULL;
     _tasks[i].ticks_ms = 0;
     _tasks[i].paused = false;
+    _tasks[i].heap_pos = -1;
+    _tasks[i].gen = 0;
   }
+#ifdef PTM_PROFILING
+  this->resetStats();
+#endif
 }
 
 PeriodicTaskManager::~PeriodicTaskManager()
 {
 }
 
-int16_t PeriodicTaskManager::searchById(int16_t id) {
-  for (uint16_t i = 0; i < MAX_TASKS; i++) {
-    if (_tasks[i].id == id) return i;
+bool PeriodicTaskManager::heapLess(uint8_t a, uint8_t b) const {
+  return isBefore(_tasks[_heap[a]].next_ms, _tasks[_heap[b]].next_ms);
+}
+
+void PeriodicTaskManager::heapSwap(uint8_t a, uint8_t b) {
+  uint8_t tmp = _heap[a];
+  _heap[a] = _heap[b];
+  _heap[b] = tmp;
+  _tasks[_heap[a]].heap_pos = a;
+  _tasks[_heap[b]].heap_pos = b;
+}
+
+void PeriodicTaskManager::siftUp(uint8_t pos) {
+  while (pos > 0) {
+    uint8_t parent = (pos - 1) / 2;
+    if (not heapLess(pos, parent)) break;
+    heapSwap(pos, parent);
+    pos = parent;
   }
-  return -1;
 }
 
-int16_t PeriodicTaskManager::searchByName(const char *name) {
+void PeriodicTaskManager::siftDown(uint8_t pos) {
+  while (true) {
+    uint8_t smallest = pos;
+    uint8_t left = 2 * pos + 1;
+    uint8_t right = left + 1;
+    if (left < _heapSize and heapLess(left, smallest)) smallest = left;
+    if (right < _heapSize and heapLess(right, smallest)) smallest = right;
+    if (smallest == pos) break;
+    heapSwap(pos, smallest);
+    pos = smallest;
+  }
+}
+
+void PeriodicTaskManager::schedule(uint8_t index) {
+  if (_tasks[index].heap_pos != -1) return;
+  _heap[_heapSize] = index;
+  _tasks[index].heap_pos = _heapSize;
+  _heapSize++;
+  siftUp(_heapSize - 1);
+}
+
+void PeriodicTaskManager::unschedule(uint8_t index) {
+  int8_t pos = _tasks[index].heap_pos;
+  if (pos == -1) return;
+  _heapSize--;
+  if (pos != _heapSize) {
+    heapSwap(pos, _heapSize);
+    siftDown(pos);
+    siftUp(pos);
+  }
+  _tasks[index].heap_pos = -1;
+}
+
+void PeriodicTaskManager::reschedule(uint8_t index) {
+  int8_t pos = _tasks[index].heap_pos;
+  if (pos == -1) return;
+  siftDown(pos);
+  siftUp(pos);
+}
+
+int16_t PeriodicTaskManager::resolve(TaskHandle handle) const {
+  if (handle.index >= MAX_TASKS or handle.gen == 0) return -1;
+  const Task &t = _tasks[handle.index];
+  if (t.task == NULL or t.gen != handle.gen) return -1;
+  return handle.index;
+}
+
+int16_t PeriodicTaskManager::searchByName(const char *name) const {
+  if (name == NULL) return -1;
   for (uint16_t i = 0; i < MAX_TASKS; i++) {
-    if (!strcmp(_tasks[i].name, name)) return _tasks[i].id;
+    // Los lugares vacíos no tienen un nombre válido
+    if (_tasks[i].task != NULL and _tasks[i].name != NULL and
+        !strcmp(_tasks[i].name, name))
+      return i;
   }
   return -1;
 }
 
-uint8_t PeriodicTaskManager::add(void (*task)(uint8_t), const char *name, uint32_t ticks_ms) {
-  uint8_t id = 0;
+TaskHandle PeriodicTaskManager::find(const char *name) const {
+  int16_t index = this->searchByName(name);
+  if (index == -1) return TaskHandle{};
+  return TaskHandle{static_cast<uint8_t>(index), _tasks[index].gen};
+}
+
+TaskHandle PeriodicTaskManager::add(void (*task)(uint8_t), const char *name, uint32_t ticks_ms,
+                                    OverrunPolicy policy) {
+  TaskHandle handle{};
   if (ticks_ms > 0 and task != NULL and _runing < MAX_TASKS) {
     uint8_t freeSpot = 0;
     while (_tasks[freeSpot].task != NULL) freeSpot++;
-    _tasks[freeSpot].id = _genid;
+    // La generación nunca es 0, así un handle vacío nunca es válido
+    if (++_tasks[freeSpot].gen == 0) _tasks[freeSpot].gen = 1;
     _tasks[freeSpot].name = name;
     _tasks[freeSpot].task = task;
     _tasks[freeSpot].ticks_ms = ticks_ms;
     _tasks[freeSpot].paused = false;
+    _tasks[freeSpot].policy = policy;
+    _tasks[freeSpot].overruns = 0;
     _tasks[freeSpot].next_ms = ticks_ms + millis();
-    id = _genid;
+#ifdef PTM_PROFILING
+    _tasks[freeSpot].stats = TaskStats{0, UINT32_MAX, 0, 0, 0, 0, 0};
+#endif
+    this->schedule(freeSpot);
+    handle = TaskHandle{freeSpot, _tasks[freeSpot].gen};
 #ifdef NDEBUG
     Serial.print(F("Added task \""));
     Serial.print(_tasks[freeSpot].name);
@@ -78,16 +169,15 @@ uint8_t PeriodicTaskManager::add(void (*task)(uint8_t), const char *name, uint32
     Serial.print(F(" at "));
     Serial.println(millis());
 #endif
-    _genid++;
     _runing++;
   }
-  return id;
+  return handle;
 }
 
-bool PeriodicTaskManager::delay(int16_t id, uint32_t ms) {
-  int16_t index = this->searchById(id);
+bool PeriodicTaskManager::delayAt(int16_t index, uint32_t ms) {
   if(index == -1) return false;
   _tasks[index].next_ms += ms;
+  this->reschedule(index);
 #ifdef NDEBUG
   Serial.print(F("Delayed task \""));
   Serial.print(_tasks[index].name);
@@ -99,12 +189,15 @@ bool PeriodicTaskManager::delay(int16_t id, uint32_t ms) {
   return true;
 }
 
+bool PeriodicTaskManager::delay(TaskHandle handle, uint32_t ms) {
+  return this->delayAt(this->resolve(handle), ms);
+}
+
 bool PeriodicTaskManager::delay(const char *name, uint32_t ms) {
-  return this->delay(this->searchByName(name), ms);
+  return this->delayAt(this->searchByName(name), ms);
 }
 
-bool PeriodicTaskManager::pause(int16_t id) {
-  int16_t index = this->searchById(id);
+bool PeriodicTaskManager::pauseAt(int16_t index) {
   if(index == -1) return false;
 #ifdef NDEBUG
   if (not _tasks[index].paused) {
@@ -113,19 +206,23 @@ bool PeriodicTaskManager::pause(int16_t id) {
     Serial.print(F("\" at "));
     Serial.println(millis());
   } else {
-    Serial.printf("Task %i already paused\r\n", id);
+    Serial.printf("Task %s already paused\r\n", _tasks[index].name);
   }
 #endif
   _tasks[index].paused = true;
+  this->unschedule(index);
   return true;
 }
 
+bool PeriodicTaskManager::pause(TaskHandle handle) {
+  return this->pauseAt(this->resolve(handle));
+}
+
 bool PeriodicTaskManager::pause(const char *name) {
-  return this->pause(this->searchByName(name));
+  return this->pauseAt(this->searchByName(name));
 }
 
-bool PeriodicTaskManager::unpause(int16_t id) {
-  int16_t index = this->searchById(id);
+bool PeriodicTaskManager::unpauseAt(int16_t index) {
   if(index == -1) return false;
 #ifdef NDEBUG
   if (_tasks[index].paused) {
@@ -134,23 +231,30 @@ bool PeriodicTaskManager::unpause(int16_t id) {
     Serial.print(F("\" at "));
     Serial.println(millis());
   } else {
-    Serial.printf("Task %i already running\r\n", id);
+    Serial.printf("Task %s already running\r\n", _tasks[index].name);
   }
 #endif
   _tasks[index].paused = false;
   _tasks[index].next_ms = millis() + _tasks[index].ticks_ms;
+  this->unschedule(index);
+  this->schedule(index);
   return true;
 }
 
+bool PeriodicTaskManager::unpause(TaskHandle handle) {
+  return this->unpauseAt(this->resolve(handle));
+}
+
 bool PeriodicTaskManager::unpause(const char *name) {
-  return this->unpause(this->searchByName(name));
+  return this->unpauseAt(this->searchByName(name));
 }
 
-bool PeriodicTaskManager::remove(int16_t id) {
-  int16_t index = this->searchById(id);
+bool PeriodicTaskManager::removeAt(int16_t index) {
   if(index == -1) return false;
+  this->unschedule(index);
   _tasks[index].task = NULL;
   _tasks[index].ticks_ms = 0;
+  _runing--;
 #ifdef NDEBUG
   Serial.print(F("Removed task \""));
   Serial.print(_tasks[index].name);
@@ -160,13 +264,33 @@ bool PeriodicTaskManager::remove(int16_t id) {
     return true;
 }
 
+bool PeriodicTaskManager::remove(TaskHandle handle) {
+  return this->removeAt(this->resolve(handle));
+}
+
 bool PeriodicTaskManager::remove(const char *name) {
-  return this->remove(this->searchByName(name));
+  return this->removeAt(this->searchByName(name));
 }
 
-bool PeriodicTaskManager::changeTicks(int16_t id, uint32_t ms) {
-  int16_t index = this->searchById(id);
-  if(index == -1) return false;
+bool PeriodicTaskManager::setPolicy(TaskHandle handle, OverrunPolicy policy) {
+  int16_t index = this->resolve(handle);
+  if (index == -1) return false;
+  _tasks[index].policy = policy;
+  return true;
+}
+
+uint32_t PeriodicTaskManager::overruns(TaskHandle handle) const {
+  int16_t index = this->resolve(handle);
+  return index == -1 ? 0 : _tasks[index].overruns;
+}
+
+uint32_t PeriodicTaskManager::overruns(uint8_t index) const {
+  if (index >= MAX_TASKS or _tasks[index].task == NULL) return 0;
+  return _tasks[index].overruns;
+}
+
+bool PeriodicTaskManager::changeTicksAt(int16_t index, uint32_t ms) {
+  if(index == -1 or ms == 0) return false;
 #ifdef NDEBUG
   Serial.print(F("Changed task \""));
   Serial.print(_tasks[index].name);
@@ -181,22 +305,102 @@ bool PeriodicTaskManager::changeTicks(int16_t id, uint32_t ms) {
   return true;
 }
 
+bool PeriodicTaskManager::changeTicks(TaskHandle handle, uint32_t ms) {
+  return this->changeTicksAt(this->resolve(handle), ms);
+}
+
 bool PeriodicTaskManager::changeTicks(const char *name, uint32_t ms) {
-  return this->changeTicks(this->searchByName(name), ms);
+  return this->changeTicksAt(this->searchByName(name), ms);
 }
 
 void PeriodicTaskManager::refresh() {
   uint32_t now = millis();
-  for (int16_t i = 0; i < MAX_TASKS; i++) {
-    if (_tasks[i].task != NULL and _tasks[i].ticks_ms != 0 and not _tasks[i].paused and _tasks[i].next_ms <= now) {
+  // Primero se sacan del heap todas las tareas vencidas, así cada una se
+  // ejecuta como mucho una vez por llamada (aunque esté atrasada).
+  uint8_t due[MAX_TASKS], due_gen[MAX_TASKS], n_due = 0;
+  while (_heapSize > 0 and not isBefore(now, _tasks[_heap[0]].next_ms)) {
+    due[n_due] = _heap[0];
+    due_gen[n_due] = _tasks[_heap[0]].gen;
+    n_due++;
+    this->unschedule(_heap[0]);
+  }
+  for (uint8_t k = 0; k < n_due; k++) {
+    uint8_t i = due[k];
+    Task &t = _tasks[i];
+    // Otra tarea pudo haberla pausado o eliminado en esta misma pasada
+    if (t.task == NULL or t.gen != due_gen[k] or t.paused or t.heap_pos != -1) continue;
 #ifdef NDEBUG
-      Serial.print(F("Executing task \""));
-      Serial.print(_tasks[i].name);
-      Serial.print(F("\" at "));
-      Serial.println(now);
+    Serial.print(F("Executing task \""));
+    Serial.print(t.name);
+    Serial.print(F("\" at "));
+    Serial.println(now);
 #endif
-      _tasks[i].task(i);
-      _tasks[i].next_ms += _tasks[i].ticks_ms;
+    uint32_t late_ms = now - t.next_ms;
+    uint32_t ticks_ms = t.ticks_ms;
+    _runs++;
+    _late_total_ms += late_ms;
+    if (late_ms > _late_max_ms) _late_max_ms = late_ms;
+    if (late_ms >= ticks_ms) {
+      t.overruns++;
+      // SKIP: el próximo vencimiento es el siguiente punto de la grilla
+      if (t.policy == OverrunPolicy::SKIP) t.next_ms += (late_ms / ticks_ms) * ticks_ms;
     }
+    // Se reagenda antes de ejecutar, así la tarea puede pausarse, demorarse
+    // o eliminarse a sí misma.
+    t.next_ms += ticks_ms;
+    this->schedule(i);
+#ifdef PTM_PROFILING
+    uint32_t start_us = micros();
+#endif
+    uint8_t gen = t.gen;
+    t.task(i);
+    // FROM_COMPLETION: se cuenta el período desde que terminó la tarea (si la
+    // tarea no se pausó ni se eliminó a sí misma)
+    if (t.policy == OverrunPolicy::FROM_COMPLETION and t.gen == gen and t.heap_pos != -1) {
+      t.next_ms = millis() + t.ticks_ms;
+      this->reschedule(i);
+    }
+#ifdef PTM_PROFILING
+    uint32_t elapsed_us = micros() - start_us;
+    TaskStats &st = t.stats;
+    st.runs++;
+    if (elapsed_us < st.min_us) st.min_us = elapsed_us;
+    if (elapsed_us > st.max_us) st.max_us = elapsed_us;
+    st.total_us += elapsed_us;
+    if (late_ms > st.max_late_ms) st.max_late_ms = late_ms;
+    st.total_late_ms += late_ms;
+    if (late_ms >= ticks_ms) st.missed++;
+#endif
   }
 }
+
+uint32_t PeriodicTaskManager::msToNextTask() {
+  if (_heapSize == 0) return UINT32_MAX;
+  int32_t diff = (int32_t)(_tasks[_heap[0]].next_ms - millis());
+  return diff > 0 ? diff : 0;
+}
+
+const char *PeriodicTaskManager::name(uint8_t index) const {
+  if (index >= MAX_TASKS or _tasks[index].task == NULL) return NULL;
+  return _tasks[index].name;
+}
+
+#ifdef PTM_PROFILING
+bool PeriodicTaskManager::stats(TaskHandle handle, TaskStats &stats) const {
+  int16_t index = this->resolve(handle);
+  if (index == -1) return false;
+  return this->stats(static_cast<uint8_t>(index), stats);
+}
+
+bool PeriodicTaskManager::stats(uint8_t index, TaskStats &stats) const {
+  if (index >= MAX_TASKS or _tasks[index].task == NULL) return false;
+  stats = _tasks[index].stats;
+  return true;
+}
+
+void PeriodicTaskManager::resetStats() {
+  for (int32_t i = 0; i < MAX_TASKS; i++) {
+    _tasks[i].stats = TaskStats{0, UINT32_MAX, 0, 0, 0, 0, 0};
+  }
+}
+#endif
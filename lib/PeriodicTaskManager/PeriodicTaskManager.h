@@ -19,8 +19,8 @@
  * @file PeriodicTaskManager.h
  * @author Matías S. Ávalos (msavalos@gmail.com)
  * @brief Simple Periodic Tasks Managment. Header file.
- * @version 0.2
- * @date 2023-07-04
+ * @version 0.4
+ * @date 2026-10-17
  * 
  * @copyright Copyright (c) 2022-2023
  * 
@@ -33,11 +33,63 @@
 #ifndef MAX_TASKS
 #define MAX_TASKS 20
 #endif
+#if MAX_TASKS > 127
+#error "MAX_TASKS no puede ser mayor a 127"
+#endif
+/**
+ * @brief Referencia a una tarea devuelta por PeriodicTaskManager::add()
+ * 
+ * Permite acceder a la tarea en O(1) (sin buscar por nombre). La generación
+ * invalida el handle si la tarea se elimina y su lugar se reutiliza.
+ * 
+ */
+struct TaskHandle {
+  uint8_t index = 0;
+  uint8_t gen = 0; // 0 == handle inválido
+  bool valid() const { return gen != 0; }
+};
+
+/**
+ * @brief Qué hacer cuando una tarea arranca tarde un período o más
+ * 
+ * CATCH_UP: se ejecuta seguido hasta recuperar los períodos perdidos.
+ * SKIP: se saltean los períodos perdidos y se realinea a la grilla original.
+ * FROM_COMPLETION: el próximo vencimiento se cuenta desde que terminó.
+ * 
+ */
+enum class OverrunPolicy : uint8_t { CATCH_UP, SKIP, FROM_COMPLETION };
+
+#ifdef PTM_PROFILING
+/**
+ * @brief Estadísticas de ejecución de una tarea (solo con PTM_PROFILING)
+ * 
+ * Los tiempos de ejecución se miden en µs con micros() y el retraso
+ * (lateness) es cuánto después de next_ms arrancó la tarea, en ms.
+ * 
+ */
+struct TaskStats {
+  uint32_t runs;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t max_late_ms;
+  uint64_t total_late_ms;
+  uint32_t missed; // veces que arrancó tarde un período completo o más
+  uint32_t mean_us() const { return runs ? total_us / runs : 0; }
+  uint32_t mean_late_ms() const { return runs ? total_late_ms / runs : 0; }
+};
+#endif
+
 /**
  * @brief Periodic Task Managment
  * 
  * Interface para ejecutar tareas (funciones) de forma periódica cada X ms
  * 
+ * Las tareas activas se mantienen en un min-heap ordenado por el próximo
+ * vencimiento (next_ms), refresh() solo mira la tarea más próxima y las
+ * comparaciones de tiempo son por diferencia con signo, así que siguen
+ * siendo correctas cuando millis() desborda (~49.7 días).
+ * 
  */
 class PeriodicTaskManager {
 private:
@@ -46,30 +98,70 @@ private:
     void (*task)(uint8_t);
     uint32_t ticks_ms;
     uint32_t next_ms;
-    uint8_t id;
+    uint32_t overruns; // veces que arrancó tarde un período completo o más
+    uint8_t gen;
+    OverrunPolicy policy;
     bool paused;
+    int8_t heap_pos; // posición en _heap, -1 si no está agendada
+#ifdef PTM_PROFILING
+    TaskStats stats;
+#endif
   };
   Task _tasks[MAX_TASKS];
-  uint8_t _genid = 0;
+  uint8_t _heap[MAX_TASKS]; // índices de _tasks, _heap[0] es la más próxima
+  uint8_t _heapSize = 0;
   uint8_t _runing = 0;
+  // Totales de todas las tareas (siempre activos, son solo sumas)
+  uint32_t _runs = 0;
+  uint64_t _late_total_ms = 0;
+  uint32_t _late_max_ms = 0;
 
 private:
-  int16_t searchByName(const char *name);
-  int16_t searchById(int16_t id);
+  int16_t searchByName(const char *name) const;
+  int16_t resolve(TaskHandle handle) const;
+  bool changeTicksAt(int16_t index, uint32_t ms);
+  bool delayAt(int16_t index, uint32_t ms);
+  bool pauseAt(int16_t index);
+  bool unpauseAt(int16_t index);
+  bool removeAt(int16_t index);
+  static bool isBefore(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+  bool heapLess(uint8_t a, uint8_t b) const;
+  void heapSwap(uint8_t a, uint8_t b);
+  void siftUp(uint8_t pos);
+  void siftDown(uint8_t pos);
+  void schedule(uint8_t index);
+  void unschedule(uint8_t index);
+  void reschedule(uint8_t index);
 
 public:
-  uint8_t add(void (*task)(uint8_t), const char *name, uint32_t ticks_ms);
-  bool changeTicks(int16_t id, uint32_t ms);
+  TaskHandle add(void (*task)(uint8_t), const char *name, uint32_t ticks_ms,
+                 OverrunPolicy policy = OverrunPolicy::CATCH_UP);
+  bool setPolicy(TaskHandle handle, OverrunPolicy policy);
+  uint32_t overruns(TaskHandle handle) const;
+  uint32_t overruns(uint8_t index) const;
+  TaskHandle find(const char *name) const;
+  bool changeTicks(TaskHandle handle, uint32_t ms);
   bool changeTicks(const char *name, uint32_t ms);
-  bool delay(int16_t id, uint32_t ms);
+  bool delay(TaskHandle handle, uint32_t ms);
   bool delay(const char *name, uint32_t ms);
-  bool pause(int16_t id);
+  bool pause(TaskHandle handle);
   bool pause(const char *name);
-  bool unpause(int16_t id);
+  bool unpause(TaskHandle handle);
   bool unpause(const char *name);
-  bool remove(int16_t id);
+  bool remove(TaskHandle handle);
   bool remove(const char *name);
   void refresh();
+  uint32_t msToNextTask();
+  const char *name(uint8_t index) const;
+  // Ejecuciones de todas las tareas y su retraso total y máximo (ms)
+  uint32_t runs() const { return _runs; }
+  uint64_t lateTotalMs() const { return _late_total_ms; }
+  uint32_t lateMaxMs() const { return _late_max_ms; }
+#ifdef PTM_PROFILING
+  bool stats(TaskHandle handle, TaskStats &stats) const;
+  bool stats(uint8_t index, TaskStats &stats) const;
+  void resetStats();
+#endif
 
 public:
   PeriodicTaskManager();
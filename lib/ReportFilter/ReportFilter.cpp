@@ -0,0 +1,114 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file ReportFilter.cpp
+ * @brief Reporte por excepción y muestreo adaptivo de los sensores. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "ReportFilter.h"
+
+static float absf(float x) { return x < 0 ? -x : x; }
+
+/**
+ * @brief Ancho de la banda muerta alrededor del último valor reportado
+ *
+ */
+float ReportFilter::band() const {
+  return _policy.percent ? absf(_reported) * _policy.deadband / 100
+                         : _policy.deadband;
+}
+
+/**
+ * @brief Cambia la política (el próximo valor se reporta seguro)
+ *
+ * @return false si no es válida (banda negativa o intervalo máximo menor
+ * al mínimo)
+ */
+bool ReportFilter::setPolicy(const ReportPolicy &policy) {
+  if (not(policy.deadband >= 0)) return false;
+  if (policy.max_interval_ms != 0 and policy.max_interval_ms < policy.min_interval_ms) {
+    return false;
+  }
+  _policy = policy;
+  _has_report = false;
+  return true;
+}
+
+/**
+ * @brief Ofrece una muestra nueva
+ *
+ * @param value la muestra
+ * @param now_ms millis() de la muestra
+ * @return true si hay que reportarla (pasa a ser reported())
+ */
+bool ReportFilter::offer(float value, uint32_t now_ms) {
+  float band = this->band();
+  _moving = _has_report and absf(value - _last) * 2 >= band;
+  _last = value;
+  uint32_t elapsed = now_ms - _reported_ms;
+  bool report = not _has_report;
+  if (not report and elapsed >= _policy.min_interval_ms) {
+    report = absf(value - _reported) > band or
+             (_policy.max_interval_ms != 0 and elapsed >= _policy.max_interval_ms);
+  }
+  if (not report) {
+    _suppressed++;
+    return false;
+  }
+  // un salto que se reporta también cuenta como movimiento
+  if (_has_report and absf(value - _reported) > band) _moving = true;
+  _reported = value;
+  _reported_ms = now_ms;
+  _has_report = true;
+  _reports++;
+  return true;
+}
+
+/**
+ * @brief Registra si la última muestra se movió
+ *
+ * Si se movió vuelve al período base; cada stable_samples muestras quietas
+ * seguidas lo duplica, hasta 2^max_shift veces.
+ */
+void AdaptivePeriod::update(bool moving) {
+  if (moving) {
+    _shift = 0;
+    _stable = 0;
+    return;
+  }
+  if (++_stable < _stable_samples) return;
+  _stable = 0;
+  if (_shift < _max_shift) _shift++;
+}
+
+/**
+ * @brief Período de muestreo actual
+ *
+ * @param base_ms período configurado
+ * @param limit_ms tope del período alargado (p.ej. el intervalo máximo de
+ * reporte), 0 sin tope. Nunca se baja del base.
+ * @return uint32_t ms
+ */
+uint32_t AdaptivePeriod::period(uint32_t base_ms, uint32_t limit_ms) const {
+  uint64_t p{uint64_t(base_ms) << _shift};
+  if (limit_ms != 0 && p > limit_ms) p = limit_ms < base_ms ? base_ms : limit_ms;
+  return p > UINT32_MAX ? UINT32_MAX : uint32_t(p);
+}
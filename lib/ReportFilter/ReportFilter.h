@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file ReportFilter.h
+ * @brief Reporte por excepción y muestreo adaptivo de los sensores. Header file.
+ * @version 0.1
+ *
+ * ReportFilter decide si una muestra se reporta: solo cuando se aleja del
+ * último valor reportado más que la banda muerta (absoluta o en % de ese
+ * valor), nunca antes del intervalo mínimo y siempre pasado el máximo.
+ * AdaptivePeriod alarga el período de muestreo (duplicándolo hasta
+ * 2^max_shift veces el base, sin pasar el límite que se le indique) mientras
+ * la señal está quieta y lo vuelve al base apenas se mueve.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __REPORTFILTER_H__
+#define __REPORTFILTER_H__
+
+#include <stdint.h>
+
+/**
+ * @brief Cuándo se reporta una señal
+ *
+ * Con percent la banda es deadband % del último valor reportado. Con
+ * max_interval_ms en 0 no hay reporte forzado.
+ */
+struct ReportPolicy {
+  float deadband;
+  bool percent;
+  uint32_t min_interval_ms;
+  uint32_t max_interval_ms;
+};
+
+/**
+ * @brief Filtro de reporte por excepción de una señal
+ *
+ */
+class ReportFilter {
+private:
+  ReportPolicy _policy;
+  float _reported = 0;
+  float _last = 0; // última muestra (se reporte o no)
+  uint32_t _reported_ms = 0;
+  bool _has_report = false;
+  bool _moving = false;
+  uint32_t _reports = 0;
+  uint32_t _suppressed = 0;
+
+public:
+  bool offer(float value, uint32_t now_ms);
+  void reset() { _has_report = false; }
+  float band() const;
+  float reported() const { return _reported; }
+  // La última muestra se movió al menos media banda respecto de la anterior
+  bool moving() const { return _moving; }
+  uint32_t reports() const { return _reports; }
+  uint32_t suppressed() const { return _suppressed; }
+  const ReportPolicy &policy() const { return _policy; }
+  bool setPolicy(const ReportPolicy &policy);
+
+  ReportFilter(const ReportPolicy &policy) : _policy{policy} {}
+};
+
+/**
+ * @brief Período de muestreo que se alarga mientras la señal está quieta
+ *
+ */
+class AdaptivePeriod {
+private:
+  uint8_t _max_shift;
+  uint8_t _stable_samples;
+  uint8_t _shift = 0;
+  uint8_t _stable = 0;
+
+public:
+  void update(bool moving);
+  uint32_t period(uint32_t base_ms, uint32_t limit_ms = 0) const;
+  uint8_t shift() const { return _shift; }
+
+  AdaptivePeriod(uint8_t max_shift, uint8_t stable_samples)
+      : _max_shift{max_shift}, _stable_samples{stable_samples} {}
+};
+
+#endif // __REPORTFILTER_H__
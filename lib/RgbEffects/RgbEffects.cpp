@@ -0,0 +1,129 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file RgbEffects.cpp
+ * @brief Efectos para el LED RGB en punto fijo. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "RgbEffects.h"
+
+#include <string.h>
+
+const char *const EFFECT_NAMES[EFFECT_COUNT]{"static", "fade", "breathe",
+                                             "wheel"};
+
+// Medio seno de 0 a 255 y vuelta a 0 para t de 0 a 255: (1 - cos) / 2
+static uint8_t bump(uint8_t t) { return rgb_lut::SINE.v[uint8_t(t - 64)]; }
+
+// Escala un valor (0-255) por level (0-255)
+static uint8_t scale(uint8_t value, uint8_t level) {
+  return (uint16_t(value) * level + 255) >> 8;
+}
+
+// Círculo cromático: 3 tramos de 85 pasos entre rojo, verde y azul
+static uint32_t wheel(uint8_t hue) {
+  if (hue < 85) return packRgb(255 - hue * 3, hue * 3, 0);
+  if (hue < 170) {
+    hue -= 85;
+    return packRgb(0, 255 - hue * 3, hue * 3);
+  }
+  hue -= 170;
+  return packRgb(hue * 3, 0, 255 - hue * 3);
+}
+
+RgbEffects::RgbEffects(RgbEffect effect, uint32_t color, uint32_t period_ms)
+    : _effect{effect}, _color{color} {
+  if (not this->setPeriod(period_ms)) this->setPeriod(RGB_PERIOD_MIN_MS);
+}
+
+/**
+ * @brief Cambia de efecto, empieza desde el principio del ciclo
+ *
+ */
+void RgbEffects::setEffect(RgbEffect effect) {
+  if (effect >= EFFECT_COUNT) return;
+  _effect = effect;
+  _phase = 0;
+  _started = false;
+}
+
+void RgbEffects::setColor(uint32_t rgb) { _color = rgb & 0xFFFFFF; }
+
+/**
+ * @brief Cambia la duración de un ciclo del efecto (sin saltos de fase)
+ *
+ * @param period_ms entre RGB_PERIOD_MIN_MS y RGB_PERIOD_MAX_MS
+ * @return false si está fuera de rango (no se cambia)
+ */
+bool RgbEffects::setPeriod(uint32_t period_ms) {
+  if (period_ms < RGB_PERIOD_MIN_MS or period_ms > RGB_PERIOD_MAX_MS) {
+    return false;
+  }
+  _period_ms = period_ms;
+  _rate = UINT32_MAX / period_ms;
+  return true;
+}
+
+/**
+ * @brief Avanza el efecto hasta now_ms y calcula el color
+ *
+ * @param now_ms millis() actual
+ * @return uint32_t el color (0xRRGGBB, sin corrección gamma)
+ */
+uint32_t RgbEffects::update(uint32_t now_ms) {
+  if (_started) _phase += _rate * (now_ms - _last_ms);
+  _last_ms = now_ms;
+  _started = true;
+  uint8_t turn = _phase >> 24; // posición en el ciclo (0-255)
+  switch (_effect) {
+  case EFFECT_FADE: {
+    // cada canal ocupa un tercio del ciclo: 2^32 / 3 de fase
+    uint8_t c = _phase / 0x55555556u;
+    uint8_t t = (_phase - c * 0x55555556u) / 0x555556u;
+    _output = uint32_t(bump(t)) << (16 - 8 * c);
+    break;
+  }
+  case EFFECT_BREATHE: {
+    uint8_t level = bump(turn);
+    _output = packRgb(scale(channel(_color, 0), level),
+                      scale(channel(_color, 1), level),
+                      scale(channel(_color, 2), level));
+    break;
+  }
+  case EFFECT_WHEEL: _output = wheel(turn); break;
+  default: _output = _color; break;
+  }
+  return _output;
+}
+
+/**
+ * @brief Busca un efecto por nombre
+ *
+ * @return RgbEffect EFFECT_COUNT si no existe
+ */
+RgbEffect RgbEffects::lookup(const char *name, size_t len) {
+  for (uint8_t e = 0; e < EFFECT_COUNT; e++) {
+    if (strlen(EFFECT_NAMES[e]) == len and not strncmp(EFFECT_NAMES[e], name, len)) {
+      return RgbEffect(e);
+    }
+  }
+  return EFFECT_COUNT;
+}
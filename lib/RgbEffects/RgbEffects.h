@@ -0,0 +1,172 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file RgbEffects.h
+ * @brief Efectos para el LED RGB en punto fijo. Header file.
+ * @version 0.1
+ *
+ * Los efectos avanzan con un acumulador de fase de 32 bits (2^32 es un ciclo)
+ * que se incrementa según los ms transcurridos, así la velocidad no depende
+ * de cada cuánto se llama a update(). Las tablas del seno y de la corrección
+ * gamma se calculan al compilar (constexpr) y el color se guarda empaquetado
+ * en un uint32_t (0xRRGGBB). Mientras el efecto está animado (animated())
+ * el color de salida cambia en cada update(), quien informa el estado debe
+ * informar el efecto y no cada color.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __RGBEFFECTS_H__
+#define __RGBEFFECTS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Exponente de la corrección gamma (x10)
+#ifndef RGB_GAMMA_X10
+#define RGB_GAMMA_X10 22
+#endif
+// Límites del período de un efecto (ms por ciclo)
+#define RGB_PERIOD_MIN_MS 100
+#define RGB_PERIOD_MAX_MS 600000
+
+/**
+ * @brief Efectos disponibles
+ *
+ * STATIC: el color fijo.
+ * FADE: sube y baja cada canal (rojo, verde y azul) en un ciclo.
+ * BREATHE: el color fijo con brillo que sube y baja.
+ * WHEEL: recorre el círculo cromático.
+ */
+enum RgbEffect : uint8_t {
+  EFFECT_STATIC,
+  EFFECT_FADE,
+  EFFECT_BREATHE,
+  EFFECT_WHEEL,
+  EFFECT_COUNT
+};
+
+// Nombres de los efectos (en el orden de RgbEffect)
+extern const char *const EFFECT_NAMES[EFFECT_COUNT];
+
+namespace rgb_lut {
+
+// Cálculo en punto flotante solo al compilar
+constexpr double PI = 3.14159265358979323846;
+
+constexpr double sine(double x) {
+  // x en [-PI, PI], serie de Taylor hasta x^17
+  double term = x, sum = x;
+  for (int n = 1; n <= 8; n++) {
+    term *= -x * x / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double ln(double x) {
+  // x en (0, 1]: se lleva a [0.5, 1] y ln(x) = 2 atanh((x - 1) / (x + 1))
+  int k = 0;
+  for (; x < 0.5; k++) x *= 2;
+  double y = (x - 1) / (x + 1), y2 = y * y, term = y, sum = 0;
+  for (int n = 1; n < 40; n += 2) {
+    sum += term / n;
+    term *= y2;
+  }
+  return 2 * sum - k * 0.69314718055994531;
+}
+
+constexpr double exp(double x) {
+  double term = 1, sum = 1;
+  for (int n = 1; n < 60; n++) {
+    term *= x / n;
+    sum += term;
+  }
+  return sum;
+}
+
+struct Table {
+  uint8_t v[256];
+};
+
+// SINE[i] = (1 + sin(2 PI i / 256)) / 2 * 255
+constexpr Table makeSine() {
+  Table t{};
+  for (int i = 0; i < 256; i++) {
+    double x = 2 * PI * (i < 128 ? i : i - 256) / 256;
+    t.v[i] = static_cast<uint8_t>((1 + sine(x)) * 127.5 + 0.5);
+  }
+  return t;
+}
+
+// GAMMA[i] = 255 * (i / 255) ^ (RGB_GAMMA_X10 / 10)
+constexpr Table makeGamma() {
+  Table t{};
+  for (int i = 1; i < 256; i++) {
+    double x = exp(ln(i / 255.0) * RGB_GAMMA_X10 / 10.0);
+    t.v[i] = static_cast<uint8_t>(255 * x + 0.5);
+  }
+  return t;
+}
+
+inline constexpr Table SINE = makeSine();
+inline constexpr Table GAMMA = makeGamma();
+
+} // namespace rgb_lut
+
+// Color empaquetado
+constexpr uint32_t packRgb(uint8_t r, uint8_t g, uint8_t b) {
+  return uint32_t(r) << 16 | uint32_t(g) << 8 | b;
+}
+constexpr uint8_t channel(uint32_t rgb, uint8_t c) {
+  return uint8_t(rgb >> (16 - 8 * c)); // 0 rojo, 1 verde, 2 azul
+}
+
+/**
+ * @brief Motor de efectos del LED RGB
+ *
+ */
+class RgbEffects {
+private:
+  RgbEffect _effect;
+  uint32_t _color;       // color base (STATIC y BREATHE)
+  uint32_t _output = 0;  // último color calculado
+  uint32_t _period_ms;
+  uint32_t _rate;        // incremento de fase por ms
+  uint32_t _phase = 0;
+  uint32_t _last_ms = 0;
+  bool _started = false;
+
+public:
+  void setEffect(RgbEffect effect);
+  void setColor(uint32_t rgb);
+  bool setPeriod(uint32_t period_ms);
+  uint32_t update(uint32_t now_ms);
+  RgbEffect effect() const { return _effect; }
+  // El color de salida cambia solo con el tiempo (todo menos STATIC)
+  bool animated() const { return _effect != EFFECT_STATIC; }
+  uint32_t color() const { return _color; }
+  uint32_t output() const { return _output; }
+  uint32_t period() const { return _period_ms; }
+  static uint8_t gamma(uint8_t value) { return rgb_lut::GAMMA.v[value]; }
+  static RgbEffect lookup(const char *name, size_t len);
+
+  RgbEffects(RgbEffect effect, uint32_t color, uint32_t period_ms);
+};
+
+#endif // __RGBEFFECTS_H__
@@ -0,0 +1,251 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SensorHistory.cpp
+ * @brief Historial de los sensores en RAM a varias resoluciones. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "SensorHistory.h"
+
+static void resetAccumulator(int16_t &min, int16_t &max, int32_t &sum,
+                             uint16_t &n) {
+  min = INT16_MAX;
+  max = INT16_MIN;
+  sum = 0;
+  n = 0;
+}
+
+SensorHistory::SensorHistory(uint32_t raw_period_ms)
+    : _raw_period_ms{raw_period_ms} {
+  const uint32_t periods[]{1000, 60000, 900000};
+  const uint16_t lens[]{HISTORY_1S_LEN, HISTORY_1M_LEN, HISTORY_15M_LEN};
+  uint16_t offset = 0;
+  for (uint8_t i = 0; i < HISTORY_LEVELS - 1; i++) {
+    Tier &t = _tiers[i];
+    t.period_ms = periods[i];
+    t.offset = offset;
+    t.len = lens[i];
+    t.total = 0;
+    t.epoch = 0;
+    for (Accumulator &a : t.acc) resetAccumulator(a.min, a.max, a.sum, a.n);
+    offset += lens[i];
+  }
+}
+
+/**
+ * @brief Agrega una muestra (se espera una cada raw_period_ms)
+ *
+ * Cuando una muestra cae en otro período de un nivel, se cierra el bucket
+ * en curso de ese nivel; si pasaron varios períodos sin muestras se agregan
+ * buckets vacíos para que los tiempos sigan siendo implícitos.
+ *
+ * @param values HISTORY_CHANNELS valores cuantizados (HISTORY_NONE si no hay)
+ * @param now_ms millis() de la muestra
+ */
+void SensorHistory::add(const int16_t *values, uint32_t now_ms) {
+  memcpy(_raw[_raw_total % HISTORY_RAW_LEN], values, sizeof(_raw[0]));
+  _raw_total++;
+  for (Tier &t : _tiers) {
+    uint32_t epoch = now_ms / t.period_ms;
+    if (not _started) {
+      t.epoch = epoch;
+    } else if (epoch != t.epoch) {
+      // Si millis() desborda (cada ~49 días) se ve como un salto grande y
+      // solo se agregan buckets vacíos
+      uint32_t gap = epoch - t.epoch;
+      this->closeBucket(t);
+      for (uint32_t k = 1; k < gap and k <= t.len; k++) this->closeBucket(t);
+      t.epoch = epoch;
+    }
+    for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+      int16_t v = values[ch];
+      if (v == HISTORY_NONE) continue;
+      Accumulator &a = t.acc[ch];
+      if (v < a.min) a.min = v;
+      if (v > a.max) a.max = v;
+      a.sum += v;
+      a.n++;
+    }
+  }
+  _started = true;
+}
+
+void SensorHistory::closeBucket(Tier &t) {
+  HistoryPoint &p = _buckets[t.offset + t.total % t.len];
+  for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+    Accumulator &a = t.acc[ch];
+    if (a.n == 0) {
+      p.min[ch] = p.max[ch] = p.mean[ch] = HISTORY_NONE;
+    } else {
+      p.min[ch] = a.min;
+      p.max[ch] = a.max;
+      // media redondeada al entero más cercano
+      int32_t half = a.sum < 0 ? -(int32_t)(a.n / 2) : a.n / 2;
+      p.mean[ch] = (a.sum + half) / a.n;
+    }
+    resetAccumulator(a.min, a.max, a.sum, a.n);
+  }
+  t.total++;
+}
+
+/**
+ * @brief Período de un nivel en ms (el 0 es el de las muestras crudas)
+ *
+ */
+uint32_t SensorHistory::period(uint8_t level) const {
+  if (level == 0) return _raw_period_ms;
+  return level < HISTORY_LEVELS ? _tiers[level - 1].period_ms : 0;
+}
+
+uint16_t SensorHistory::capacity(uint8_t level) const {
+  if (level == 0) return HISTORY_RAW_LEN;
+  return level < HISTORY_LEVELS ? _tiers[level - 1].len : 0;
+}
+
+/**
+ * @brief Cantidad de puntos agregados desde el arranque a un nivel (número
+ * de secuencia del próximo punto)
+ *
+ */
+uint32_t SensorHistory::total(uint8_t level) const {
+  if (level == 0) return _raw_total;
+  return level < HISTORY_LEVELS ? _tiers[level - 1].total : 0;
+}
+
+/**
+ * @brief Número de secuencia del punto más viejo que sigue guardado
+ *
+ */
+uint32_t SensorHistory::oldest(uint8_t level) const {
+  uint32_t total = this->total(level);
+  uint16_t cap = this->capacity(level);
+  return total > cap ? total - cap : 0;
+}
+
+/**
+ * @brief Lee un punto
+ *
+ * @param level nivel (0 crudo, 1 a 3 buckets)
+ * @param seq número de secuencia del punto
+ * @param point destino
+ * @return false si el punto ya no está guardado o todavía no existe
+ */
+bool SensorHistory::at(uint8_t level, uint32_t seq, HistoryPoint &point) const {
+  if (level >= HISTORY_LEVELS or seq < this->oldest(level) or
+      seq >= this->total(level)) {
+    return false;
+  }
+  if (level == 0) {
+    const int16_t *raw = _raw[seq % HISTORY_RAW_LEN];
+    memcpy(point.min, raw, sizeof(point.min));
+    memcpy(point.max, raw, sizeof(point.max));
+    memcpy(point.mean, raw, sizeof(point.mean));
+  } else {
+    const Tier &t = _tiers[level - 1];
+    point = _buckets[t.offset + seq % t.len];
+  }
+  return true;
+}
+
+// Escribe un arreglo JSON codificado en deltas: el primer valor es absoluto
+// y los demás la diferencia con el anterior que no sea null
+static void writeDeltas(BufferWriter &w, const int16_t *values, uint16_t n) {
+  w.put('[');
+  int32_t last = 0;
+  bool first = true;
+  for (uint16_t i = 0; i < n; i++) {
+    if (i) w.put(',');
+    if (values[i] == HISTORY_NONE) {
+      w.put("null");
+      continue;
+    }
+    w.putInt(first ? values[i] : values[i] - last);
+    last = values[i];
+    first = false;
+  }
+  w.put(']');
+}
+
+/**
+ * @brief Escribe en JSON una parte del historial de un nivel
+ *
+ * {"his":nivel,"period":ms,"seq":primero,"n":puntos,"end":bool,
+ *  "<canal>":[...]} en el nivel 0, o "<canal>":{"mean":[...],"min":[...],
+ * "max":[...]} en los demás, ordenados del más viejo al más nuevo y
+ * codificados en deltas (ver writeDeltas).
+ *
+ * @param level nivel
+ * @param seq primer punto (si ya no está se empieza por oldest())
+ * @param max_points cantidad máxima de puntos (a lo sumo 32)
+ * @param names nombre de cada canal
+ * @param w destino
+ * @return uint16_t cantidad de puntos escritos, el próximo es seq + n
+ */
+uint16_t SensorHistory::writeChunk(uint8_t level, uint32_t seq,
+                                   uint16_t max_points,
+                                   const char *const names[HISTORY_CHANNELS],
+                                   BufferWriter &w) const {
+  const uint16_t MAX_CHUNK = 32;
+  if (level >= HISTORY_LEVELS) return 0;
+  if (seq < this->oldest(level)) seq = this->oldest(level);
+  uint32_t total = this->total(level);
+  uint16_t n = seq < total ? total - seq : 0;
+  if (n > max_points) n = max_points;
+  if (n > MAX_CHUNK) n = MAX_CHUNK;
+
+  w.put("{\"his\":");
+  w.putUInt(level);
+  w.put(",\"period\":");
+  w.putUInt(this->period(level));
+  w.put(",\"seq\":");
+  w.putUInt(seq);
+  w.put(",\"n\":");
+  w.putUInt(n);
+  w.put(",\"end\":");
+  w.putBool(seq + n >= total);
+  int16_t values[3][MAX_CHUNK];
+  for (uint8_t ch = 0; ch < HISTORY_CHANNELS; ch++) {
+    for (uint16_t i = 0; i < n; i++) {
+      HistoryPoint p;
+      this->at(level, seq + i, p);
+      values[0][i] = p.mean[ch];
+      values[1][i] = p.min[ch];
+      values[2][i] = p.max[ch];
+    }
+    w.put(",\"");
+    w.put(names[ch]);
+    w.put("\":");
+    if (level == 0) {
+      writeDeltas(w, values[0], n);
+    } else {
+      w.put("{\"mean\":");
+      writeDeltas(w, values[0], n);
+      w.put(",\"min\":");
+      writeDeltas(w, values[1], n);
+      w.put(",\"max\":");
+      writeDeltas(w, values[2], n);
+      w.put('}');
+    }
+  }
+  w.put('}');
+  return n;
+}
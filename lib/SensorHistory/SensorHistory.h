@@ -0,0 +1,119 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SensorHistory.h
+ * @brief Historial de los sensores en RAM a varias resoluciones. Header file.
+ * @version 0.1
+ *
+ * Las muestras se guardan cuantizadas en int16_t: un anillo con las muestras
+ * tal cual llegan (nivel 0) y anillos de buckets con mínimo, máximo y media
+ * cada 1 s, 1 min y 15 min (niveles 1 a 3). Todo el almacenamiento es
+ * estático, su tamaño se conoce al compilar (SensorHistory::bytes()).
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __SENSORHISTORY_H__
+#define __SENSORHISTORY_H__
+
+#include <BoardState.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Cantidad de canales (magnitudes) por muestra
+#ifndef HISTORY_CHANNELS
+#define HISTORY_CHANNELS 4
+#endif
+// Muestras crudas que se guardan
+#ifndef HISTORY_RAW_LEN
+#define HISTORY_RAW_LEN 64
+#endif
+// Buckets de 1 s, 1 min y 15 min que se guardan
+#ifndef HISTORY_1S_LEN
+#define HISTORY_1S_LEN 60
+#endif
+#ifndef HISTORY_1M_LEN
+#define HISTORY_1M_LEN 60
+#endif
+#ifndef HISTORY_15M_LEN
+#define HISTORY_15M_LEN 48
+#endif
+// Valor de un canal sin dato (sensor desconectado)
+#define HISTORY_NONE INT16_MIN
+// Niveles: 0 crudo, 1 a 3 buckets
+#define HISTORY_LEVELS 4
+
+/**
+ * @brief Un punto del historial (en el nivel 0 min, max y mean son iguales)
+ *
+ */
+struct HistoryPoint {
+  int16_t min[HISTORY_CHANNELS];
+  int16_t max[HISTORY_CHANNELS];
+  int16_t mean[HISTORY_CHANNELS];
+};
+
+/**
+ * @brief Historial de HISTORY_CHANNELS canales a varias resoluciones
+ *
+ * Los puntos se identifican con un número de secuencia por nivel que nunca
+ * se repite: el más viejo disponible es oldest() y el próximo en llegar es
+ * total(). Así quien lo recorre de a partes no se pierde si llegan puntos
+ * nuevos mientras tanto.
+ */
+class SensorHistory {
+private:
+  struct Accumulator {
+    int16_t min, max;
+    int32_t sum;
+    uint16_t n;
+  };
+  struct Tier {
+    uint32_t period_ms;
+    uint16_t offset, len;
+    uint32_t total;
+    uint32_t epoch;
+    Accumulator acc[HISTORY_CHANNELS];
+  };
+  uint32_t _raw_period_ms;
+  int16_t _raw[HISTORY_RAW_LEN][HISTORY_CHANNELS];
+  uint32_t _raw_total = 0;
+  HistoryPoint _buckets[HISTORY_1S_LEN + HISTORY_1M_LEN + HISTORY_15M_LEN];
+  Tier _tiers[HISTORY_LEVELS - 1];
+  bool _started = false;
+  void closeBucket(Tier &tier);
+
+public:
+  void add(const int16_t *values, uint32_t now_ms);
+  uint32_t period(uint8_t level) const;
+  uint16_t capacity(uint8_t level) const;
+  uint32_t total(uint8_t level) const;
+  uint32_t oldest(uint8_t level) const;
+  bool at(uint8_t level, uint32_t seq, HistoryPoint &point) const;
+  uint16_t writeChunk(uint8_t level, uint32_t seq, uint16_t max_points,
+                      const char *const names[HISTORY_CHANNELS],
+                      BufferWriter &w) const;
+  static constexpr size_t bytes();
+
+  SensorHistory(uint32_t raw_period_ms);
+};
+
+constexpr size_t SensorHistory::bytes() { return sizeof(SensorHistory); }
+
+#endif // __SENSORHISTORY_H__
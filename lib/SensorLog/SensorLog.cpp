@@ -0,0 +1,180 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SensorLog.cpp
+ * @brief Registro persistente de los sensores en el filesystem. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "SensorLog.h"
+
+// Largo máximo de la ruta de un segmento: <dir>/xxxxxxxx
+#define LOG_PATH_MAX 32
+
+SensorLog::SensorLog(fs::FS &fs, const char *dir) : _fs{fs}, _dir{dir} {}
+
+void SensorLog::segmentPath(uint32_t seq, char *path) const {
+  snprintf(path, LOG_PATH_MAX, "%s/%08x", _dir,
+           (unsigned)(seq - seq % LOG_SEGMENT_RECORDS));
+}
+
+/**
+ * @brief Busca los segmentos existentes y continúa la numeración
+ *
+ * Si el último segmento quedó con un registro a medias (por ejemplo por un
+ * corte de energía durante la escritura) se descarta ese registro.
+ *
+ * @return false si no se pudo crear el directorio
+ */
+bool SensorLog::begin() {
+  if (not _fs.exists(_dir) and not _fs.mkdir(_dir)) return false;
+  bool found = false;
+  uint32_t oldest = 0, newest = 0;
+  size_t newest_size = 0;
+  fs::Dir dir = _fs.openDir(_dir);
+  while (dir.next()) {
+    char *end;
+    uint32_t seg = strtoul(dir.fileName().c_str(), &end, 16);
+    if (*end != '\0') continue; // no es un segmento
+    if (not found or seg < oldest) oldest = seg;
+    if (not found or seg > newest) {
+      newest = seg;
+      newest_size = dir.fileSize();
+    }
+    found = true;
+  }
+  _pending = 0;
+  if (not found) {
+    _first = _flushed = 0;
+    return true;
+  }
+  uint32_t records = newest_size / sizeof(LogRecord);
+  if (newest_size % sizeof(LogRecord)) {
+    char path[LOG_PATH_MAX];
+    this->segmentPath(newest, path);
+    fs::File f = _fs.open(path, "r+");
+    if (f) {
+      f.truncate(records * sizeof(LogRecord));
+      f.close();
+    }
+  }
+  _first = oldest;
+  _flushed = newest + records;
+  return true;
+}
+
+/**
+ * @brief Agrega un registro (en RAM), cuando se juntan LOG_BATCH se
+ * escriben todos juntos
+ *
+ * @param values LOG_CHANNELS valores
+ * @param now_ms millis() de la muestra
+ * @return false si no había lugar (falló la escritura anterior y sigue
+ * fallando), el registro se descarta
+ */
+bool SensorLog::add(const int16_t *values, uint32_t now_ms) {
+  if (_pending >= LOG_BATCH and not this->flush()) return false;
+  LogRecord &r = _batch[_pending];
+  r.seq = _flushed + _pending;
+  r.uptime_ms = now_ms;
+  memcpy(r.values, values, sizeof(r.values));
+  _pending++;
+  if (_pending == LOG_BATCH) this->flush();
+  return true;
+}
+
+/**
+ * @brief Escribe los registros pendientes
+ *
+ * Como mucho se escriben LOG_BATCH registros (una escritura por segmento
+ * involucrado, a lo sumo dos), así el tiempo de cada llamada está acotado.
+ *
+ * @return false si falló la escritura (los registros quedan pendientes)
+ */
+bool SensorLog::flush() {
+  uint8_t done = 0;
+  bool ok = true;
+  while (done < _pending) {
+    uint16_t room = LOG_SEGMENT_RECORDS - _flushed % LOG_SEGMENT_RECORDS;
+    uint16_t n = _pending - done < room ? _pending - done : room;
+    if (not this->appendToSegment(&_batch[done], n)) {
+      _errors++;
+      ok = false;
+      break;
+    }
+    done += n;
+    _flushed += n;
+  }
+  if (done) {
+    memmove(_batch, _batch + done, (_pending - done) * sizeof(LogRecord));
+    _pending -= done;
+    _flushes++;
+  }
+  return ok;
+}
+
+bool SensorLog::appendToSegment(const LogRecord *records, uint16_t n) {
+  // Al empezar un segmento nuevo se borran los más viejos que sobran
+  if (_flushed % LOG_SEGMENT_RECORDS == 0) {
+    char old[LOG_PATH_MAX];
+    while ((_flushed - _first) / LOG_SEGMENT_RECORDS + 1 > LOG_MAX_SEGMENTS) {
+      this->segmentPath(_first, old);
+      _fs.remove(old);
+      _first += LOG_SEGMENT_RECORDS;
+    }
+  }
+  char path[LOG_PATH_MAX];
+  this->segmentPath(_flushed, path);
+  fs::File f = _fs.open(path, "a");
+  if (not f) return false;
+  size_t len = n * sizeof(LogRecord);
+  size_t written = f.write(reinterpret_cast<const uint8_t *>(records), len);
+  f.close();
+  return written == len;
+}
+
+/**
+ * @brief Lee el log ya escrito a partir de una posición
+ *
+ * Lee de un solo segmento por llamada, quien lo usa debe seguir llamando
+ * con la nueva posición hasta que devuelva 0.
+ *
+ * @param offset posición en bytes en el log completo (seq * tamaño)
+ * @param buf destino
+ * @param len cantidad máxima de bytes
+ * @return size_t bytes leídos, 0 si no hay más (o el segmento se borró)
+ */
+size_t SensorLog::read(uint32_t offset, uint8_t *buf, size_t len) {
+  uint32_t seq = offset / sizeof(LogRecord);
+  if (seq < _first or seq >= _flushed) return 0;
+  uint32_t seg_start = (seq - seq % LOG_SEGMENT_RECORDS) * sizeof(LogRecord);
+  uint32_t seg_end = seg_start + LOG_SEGMENT_RECORDS * sizeof(LogRecord);
+  uint32_t log_end = _flushed * sizeof(LogRecord);
+  if (seg_end > log_end) seg_end = log_end;
+  if (len > seg_end - offset) len = seg_end - offset;
+  char path[LOG_PATH_MAX];
+  this->segmentPath(seq, path);
+  fs::File f = _fs.open(path, "r");
+  if (not f) return 0;
+  size_t n = f.seek(offset - seg_start) ? f.read(buf, len) : 0;
+  f.close();
+  return n;
+}
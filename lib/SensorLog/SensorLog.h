@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SensorLog.h
+ * @brief Registro persistente de los sensores en el filesystem. Header file.
+ * @version 0.1
+ *
+ * Los registros son de tamaño fijo y se numeran desde el primero que se
+ * escribió (seq). Se acumulan en RAM y se agregan de a LOG_BATCH al final
+ * de archivos (segmentos) de LOG_SEGMENT_RECORDS registros, cada segmento se
+ * llama como su primer seq en hexadecimal. Cuando hay más de
+ * LOG_MAX_SEGMENTS se borra el más viejo.
+ *
+ * La posición de un registro en el log completo es seq * sizeof(LogRecord),
+ * así quien descarga el log puede pedir solo lo que le falta.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __SENSORLOG_H__
+#define __SENSORLOG_H__
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Canales de cada registro
+#ifndef LOG_CHANNELS
+#define LOG_CHANNELS 4
+#endif
+// Registros que se acumulan en RAM antes de escribirlos (una escritura)
+#ifndef LOG_BATCH
+#define LOG_BATCH 32
+#endif
+// Registros por segmento
+#ifndef LOG_SEGMENT_RECORDS
+#define LOG_SEGMENT_RECORDS 512
+#endif
+// Segmentos que se conservan
+#ifndef LOG_MAX_SEGMENTS
+#define LOG_MAX_SEGMENTS 8
+#endif
+
+/**
+ * @brief Registro del log (little-endian, 8 + 2 * LOG_CHANNELS bytes)
+ *
+ */
+struct __attribute__((packed)) LogRecord {
+  uint32_t seq;       // número de registro desde el primero escrito
+  uint32_t uptime_ms; // millis() al tomar la muestra
+  int16_t values[LOG_CHANNELS];
+};
+
+/**
+ * @brief Log de registros de tamaño fijo en segmentos rotativos
+ *
+ */
+class SensorLog {
+private:
+  fs::FS &_fs;
+  const char *_dir;
+  LogRecord _batch[LOG_BATCH];
+  uint8_t _pending = 0;
+  uint32_t _first = 0;   // primer seq guardado
+  uint32_t _flushed = 0; // seq del próximo registro a escribir
+  uint32_t _flushes = 0;
+  uint32_t _errors = 0;
+  void segmentPath(uint32_t seq, char *path) const;
+  bool appendToSegment(const LogRecord *records, uint16_t n);
+
+public:
+  bool begin();
+  bool add(const int16_t *values, uint32_t now_ms);
+  bool flush();
+  size_t read(uint32_t offset, uint8_t *buf, size_t len);
+  uint32_t first() const { return _first; }
+  uint32_t flushed() const { return _flushed; }
+  uint32_t total() const { return _flushed + _pending; }
+  uint8_t pending() const { return _pending; }
+  uint32_t flushes() const { return _flushes; }
+  uint32_t errors() const { return _errors; }
+
+  SensorLog(fs::FS &fs, const char *dir);
+};
+
+#endif // __SENSORLOG_H__
@@ -0,0 +1,153 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SplitPhaseSensor.cpp
+ * @brief Lectura no bloqueante de sensores I2C en dos fases. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "SplitPhaseSensor.h"
+
+// Si el sensor sigue ocupado pasado este múltiplo del tiempo de conversión,
+// se descarta la medición
+#define SPS_BUSY_LIMIT 4
+
+SplitPhaseSensor::SplitPhaseSensor(uint8_t address, uint32_t conversion_ms,
+                                   TwoWire &wire)
+    : _address{address}, _conversion_ms{conversion_ms}, _wire{wire} {}
+
+bool SplitPhaseSensor::command(uint8_t cmd) { return this->command(&cmd, 1); }
+
+bool SplitPhaseSensor::command(const uint8_t *cmd, uint8_t len) {
+  _transactions++;
+  _wire.beginTransmission(_address);
+  for (uint8_t i = 0; i < len; i++) _wire.write(cmd[i]);
+  return _wire.endTransmission() == 0;
+}
+
+bool SplitPhaseSensor::receive(uint8_t *buf, uint8_t len) {
+  _transactions++;
+  if (_wire.requestFrom(_address, len) != len) return false;
+  for (uint8_t i = 0; i < len; i++) buf[i] = _wire.read();
+  return true;
+}
+
+/**
+ * @brief Avanza una fase de la lectura
+ *
+ * Si no hay una conversión en curso la dispara, si la hay y ya pasó el
+ * tiempo de conversión lee el resultado (ver takeReading()).
+ *
+ * @param period_ms cada cuánto se quiere una lectura (de disparo a disparo)
+ * @return uint32_t ms hasta la próxima llamada (siempre mayor a 0)
+ */
+uint32_t SplitPhaseSensor::step(uint32_t period_ms) {
+  uint32_t now = millis();
+  if (not _converting) {
+    if (not this->trigger()) {
+      _errors++;
+      return period_ms;
+    }
+    _converting = true;
+    _trigger_ms = now;
+    return _conversion_ms;
+  }
+  uint32_t elapsed = now - _trigger_ms;
+  if (elapsed < _conversion_ms) return _conversion_ms - elapsed;
+  CollectResult result = this->collect();
+  if (result == CollectResult::BUSY and elapsed < SPS_BUSY_LIMIT * _conversion_ms) {
+    return _conversion_ms / SPS_BUSY_LIMIT + 1;
+  }
+  _converting = false;
+  if (result == CollectResult::OK) {
+    _fresh = true;
+  } else {
+    _errors++;
+  }
+  return period_ms > elapsed ? period_ms - elapsed : 1;
+}
+
+/**
+ * @brief Indica si hay una lectura nueva desde la última consulta
+ *
+ * @return true una sola vez por cada lectura
+ */
+bool SplitPhaseSensor::takeReading() {
+  bool fresh = _fresh;
+  _fresh = false;
+  return fresh;
+}
+
+/**
+ * @brief Descarta la conversión en curso (por ejemplo si se desconectó)
+ *
+ */
+void SplitPhaseSensor::reset() {
+  _converting = false;
+  _fresh = false;
+}
+
+AHT10Sensor::AHT10Sensor(uint8_t address, TwoWire &wire)
+    : SplitPhaseSensor{address, CONVERSION_MS, wire} {}
+
+bool AHT10Sensor::begin() {
+  // Inicialización: carga los coeficientes de calibración de fábrica
+  const uint8_t init[]{0xE1, 0x08, 0x00};
+  this->reset();
+  return this->command(init, sizeof(init));
+}
+
+bool AHT10Sensor::trigger() {
+  const uint8_t measure[]{0xAC, 0x33, 0x00};
+  return this->command(measure, sizeof(measure));
+}
+
+CollectResult AHT10Sensor::collect() {
+  // estado, 20 bits de humedad y 20 bits de temperatura
+  uint8_t raw[6];
+  if (not this->receive(raw, sizeof(raw))) return CollectResult::ERROR;
+  if (raw[0] & 0x80) return CollectResult::BUSY;
+  uint32_t h = (uint32_t)raw[1] << 12 | (uint32_t)raw[2] << 4 | raw[3] >> 4;
+  uint32_t t = (uint32_t)(raw[3] & 0x0F) << 16 | (uint32_t)raw[4] << 8 | raw[5];
+  _humidity = h * 100.0f / 1048576.0f;
+  _temperature = t * 200.0f / 1048576.0f - 50.0f;
+  return CollectResult::OK;
+}
+
+BH1750Sensor::BH1750Sensor(uint8_t address, TwoWire &wire)
+    : SplitPhaseSensor{address, CONVERSION_MS, wire} {}
+
+bool BH1750Sensor::begin() {
+  this->reset();
+  return this->command(0x01); // Power On
+}
+
+bool BH1750Sensor::trigger() {
+  return this->command(0x20); // One Time H-Resolution Mode
+}
+
+CollectResult BH1750Sensor::collect() {
+  uint8_t raw[2];
+  if (not this->receive(raw, sizeof(raw))) return CollectResult::ERROR;
+  // 1 cuenta = 1/1.2 lx con el tiempo de medición por defecto (MTreg 69)
+  _lux = ((uint16_t)raw[0] << 8 | raw[1]) / 1.2f;
+  return CollectResult::OK;
+}
@@ -0,0 +1,137 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SplitPhaseSensor.h
+ * @brief Lectura no bloqueante de sensores I2C en dos fases. Header file.
+ * @version 0.1
+ *
+ * Cada lectura se divide en dos llamadas: la primera dispara la conversión
+ * y vuelve enseguida, la segunda (pasado el tiempo de conversión de la hoja
+ * de datos) lee el resultado. Entre ambas el loop() queda libre para las
+ * demás tareas, nunca se espera con delay() ni se sondea el sensor.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __SPLITPHASESENSOR_H__
+#define __SPLITPHASESENSOR_H__
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/**
+ * @brief Resultado de leer una conversión
+ *
+ */
+enum class CollectResult : uint8_t {
+  OK,    // hay una lectura nueva
+  BUSY,  // el sensor todavía está convirtiendo, se reintenta
+  ERROR, // no respondió o la lectura no es válida
+};
+
+/**
+ * @brief Sensor I2C que se lee disparando la conversión y leyendo después
+ *
+ * Se usa desde una tarea del PeriodicTaskManager: step() devuelve cuántos ms
+ * faltan para volver a llamarla (el tiempo de conversión o lo que resta del
+ * período), y se aplica con changeTicks() sobre la misma tarea.
+ */
+class SplitPhaseSensor {
+private:
+  uint8_t _address;
+  uint32_t _conversion_ms;
+  uint32_t _trigger_ms = 0;
+  bool _converting = false;
+  bool _fresh = false;
+  uint32_t _errors = 0;
+  uint32_t _transactions = 0;
+
+protected:
+  TwoWire &_wire;
+  bool command(uint8_t cmd);
+  bool command(const uint8_t *cmd, uint8_t len);
+  bool receive(uint8_t *buf, uint8_t len);
+  virtual bool trigger() = 0;
+  virtual CollectResult collect() = 0;
+
+public:
+  uint8_t address() const { return _address; }
+  uint32_t conversionMs() const { return _conversion_ms; }
+  bool converting() const { return _converting; }
+  uint32_t errors() const { return _errors; }
+  // Transacciones en el bus (escrituras y lecturas, incluso las fallidas)
+  uint32_t transactions() const { return _transactions; }
+  uint32_t step(uint32_t period_ms);
+  bool takeReading();
+  void reset();
+  virtual bool begin() = 0;
+
+  SplitPhaseSensor(uint8_t address, uint32_t conversion_ms, TwoWire &wire);
+  virtual ~SplitPhaseSensor() {}
+};
+
+/**
+ * @brief AHT10: una conversión entrega temperatura y humedad juntas
+ *
+ */
+class AHT10Sensor : public SplitPhaseSensor {
+private:
+  float _temperature = 0;
+  float _humidity = 0;
+
+protected:
+  bool trigger() override;
+  CollectResult collect() override;
+
+public:
+  static const uint8_t ADDRESS = 0x38;
+  // Tiempo de conversión de la hoja de datos (>75ms)
+  static const uint32_t CONVERSION_MS = 80;
+  bool begin() override;
+  float temperature() const { return _temperature; }
+  float humidity() const { return _humidity; }
+
+  AHT10Sensor(uint8_t address = ADDRESS, TwoWire &wire = Wire);
+};
+
+/**
+ * @brief BH1750 en modo de una sola medición en alta resolución
+ *
+ * Tras cada medición el sensor se apaga solo, no hace falta sondear si la
+ * medición está lista como en el modo continuo.
+ */
+class BH1750Sensor : public SplitPhaseSensor {
+private:
+  float _lux = 0;
+
+protected:
+  bool trigger() override;
+  CollectResult collect() override;
+
+public:
+  static const uint8_t ADDRESS = 0x23;
+  // Tiempo de conversión máximo de la hoja de datos (H-Resolution Mode)
+  static const uint32_t CONVERSION_MS = 180;
+  bool begin() override;
+  float lux() const { return _lux; }
+
+  BH1750Sensor(uint8_t address = ADDRESS, TwoWire &wire = Wire);
+};
+
+#endif // __SPLITPHASESENSOR_H__
@@ -0,0 +1,148 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file SpscQueue.h
+ * @brief Cola circular de un productor y un consumidor sin locks.
+ * @version 0.1
+ *
+ * Capacidad fija y sin memoria dinámica. Un solo contexto escribe (push) y
+ * otro solo lee (pop): el productor solo modifica _head y el consumidor solo
+ * _tail, así no hacen falta secciones críticas.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __SPSCQUEUE_H__
+#define __SPSCQUEUE_H__
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// El lado del productor puede usarse desde una interrupción: se fuerza que
+// quede inline en la ISR (que en el ESP8266 tiene que estar en IRAM, fuera de
+// la caché de la flash)
+#define SPSC_PRODUCER __attribute__((always_inline)) inline
+
+/**
+ * @brief Cola de N elementos de tipo T (N potencia de 2)
+ *
+ * Los índices crecen libremente y se enmascaran al acceder, la diferencia
+ * entre ambos es la cantidad de elementos (también al desbordar uint32_t).
+ */
+template <typename T, uint32_t N> class SpscQueue {
+  static_assert(N > 0 and (N & (N - 1)) == 0, "N debe ser potencia de 2");
+
+private:
+  T _items[N]{};
+  std::atomic<uint32_t> _head{0}; // lo escribe solo el productor
+  std::atomic<uint32_t> _tail{0}; // lo escribe solo el consumidor
+  uint32_t _overflows = 0;        // lo escribe solo el productor
+  uint32_t _high_water = 0;       // lo escribe solo el productor
+
+public:
+  /**
+   * @brief Encola un elemento (solo desde el productor)
+   *
+   * @return false si la cola estaba llena (se cuenta en overflows())
+   */
+  SPSC_PRODUCER bool push(const T &item) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    uint32_t used = head - _tail.load(std::memory_order_acquire);
+    if (used >= N) {
+      _overflows++;
+      return false;
+    }
+    _items[head & (N - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+    if (used + 1 > _high_water) _high_water = used + 1;
+    return true;
+  }
+
+  /**
+   * @brief Lugar libre para escribir un elemento en el lugar, sin copiarlo
+   * (solo desde el productor). Se confirma con commit().
+   *
+   * @return T* nullptr si la cola estaba llena (se cuenta en overflows())
+   */
+  SPSC_PRODUCER T *reserve() {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= N) {
+      _overflows++;
+      return nullptr;
+    }
+    return &_items[head & (N - 1)];
+  }
+
+  /**
+   * @brief Publica el elemento devuelto por reserve()
+   *
+   */
+  SPSC_PRODUCER void commit() {
+    uint32_t head = _head.load(std::memory_order_relaxed) + 1;
+    _head.store(head, std::memory_order_release);
+    uint32_t used = head - _tail.load(std::memory_order_relaxed);
+    if (used > _high_water) _high_water = used;
+  }
+
+  /**
+   * @brief Primer elemento de la cola sin sacarlo (solo desde el
+   * consumidor). Se libera con release().
+   *
+   * @return T* nullptr si la cola está vacía
+   */
+  T *front() {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (_head.load(std::memory_order_acquire) == tail) return nullptr;
+    return &_items[tail & (N - 1)];
+  }
+
+  /**
+   * @brief Saca el elemento devuelto por front()
+   *
+   */
+  void release() {
+    _tail.store(_tail.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  /**
+   * @brief Desencola un elemento (solo desde el consumidor)
+   *
+   * @return false si la cola estaba vacía
+   */
+  bool pop(T &item) {
+    T *first = this->front();
+    if (first == nullptr) return false;
+    item = *first;
+    this->release();
+    return true;
+  }
+
+  uint32_t size() const {
+    return _head.load(std::memory_order_acquire) -
+           _tail.load(std::memory_order_acquire);
+  }
+  bool empty() const { return this->size() == 0; }
+  static constexpr uint32_t capacity() { return N; }
+  uint32_t overflows() const { return _overflows; }
+  uint32_t highWater() const { return _high_water; }
+};
+
+#endif // __SPSCQUEUE_H__
@@ -0,0 +1,74 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file StatePush.cpp
+ * @brief Decisión del envío del estado a cada cliente suscripto. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "StatePush.h"
+
+/**
+ * @brief Decide qué se le envía a un cliente en esta vuelta
+ *
+ * @param backlog estado retenido del cliente
+ * @param changed el estado cambió desde el último envío
+ * @param keepalive toca reenviar el estado aunque no haya cambiado
+ * @param has_room se le puede encolar un mensaje más al cliente
+ * @param partial hay un delta con los campos que cambiaron (cliente binario)
+ * @return PushAction
+ */
+PushAction pushAction(const StateBacklog &backlog, bool changed,
+                      bool keepalive, bool has_room, bool partial) {
+  if (!changed && !keepalive && !backlog.pending) return PUSH_SKIP;
+  if (!has_room) return PUSH_HOLD;
+  // Con un estado retenido el delta no alcanza: se perdieron los intermedios
+  return partial && !backlog.pending ? PUSH_DELTA : PUSH_FULL;
+}
+
+/**
+ * @brief Retiene el estado de un cliente (el último gana)
+ *
+ * @param backlog estado retenido del cliente
+ * @param changed el estado cambió (reemplaza al que estaba retenido)
+ * @param now_ms millis()
+ */
+void pushHold(StateBacklog &backlog, bool changed, uint32_t now_ms) {
+  if (!backlog.pending) {
+    backlog.since_ms = now_ms;
+    backlog.pending = true;
+  } else if (changed) {
+    backlog.coalesced++;
+  }
+}
+
+/**
+ * @brief Registra que al cliente se le envió el estado
+ *
+ * @param backlog estado retenido del cliente (registra la demora máxima)
+ * @param now_ms millis()
+ */
+void pushSent(StateBacklog &backlog, uint32_t now_ms) {
+  if (backlog.pending) {
+    uint32_t lag{now_ms - backlog.since_ms};
+    if (lag > backlog.max_lag_ms) backlog.max_lag_ms = lag;
+  }
+  backlog.pending = false;
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file StatePush.h
+ * @brief Decisión del envío del estado a cada cliente suscripto. Header file.
+ * @version 0.1
+ *
+ * A un cliente con la cola llena no se le agregan mensajes: el estado se le
+ * retiene y, cuando se desagota, recibe solo el último completo (el último
+ * estado gana, los intermedios se cuentan como reemplazados). Los clientes
+ * binarios al día reciben solo los campos que cambiaron.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __STATEPUSH_H__
+#define __STATEPUSH_H__
+
+#include <stdint.h>
+
+/**
+ * @brief Qué hacer con el estado para un cliente
+ *
+ */
+enum PushAction : uint8_t {
+  PUSH_SKIP,  // no hay nada que enviarle
+  PUSH_HOLD,  // no tiene lugar: se le retiene el estado
+  PUSH_DELTA, // solo los campos que cambiaron (binario)
+  PUSH_FULL   // el estado completo
+};
+
+/**
+ * @brief Estado retenido de un cliente y sus contadores
+ *
+ */
+struct StateBacklog {
+  bool pending;        // se le retuvo el estado, recibe el último completo
+  uint32_t since_ms;   // millis() desde que se le retiene el estado
+  uint32_t coalesced;  // estados reemplazados por uno más nuevo
+  uint32_t max_lag_ms; // máxima demora de un estado retenido
+};
+
+PushAction pushAction(const StateBacklog &backlog, bool changed,
+                      bool keepalive, bool has_room, bool partial);
+void pushHold(StateBacklog &backlog, bool changed, uint32_t now_ms);
+void pushSent(StateBacklog &backlog, uint32_t now_ms);
+
+#endif // __STATEPUSH_H__
@@ -0,0 +1,87 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file StaticSlot.h
+ * @brief Lugar reservado estáticamente para construir un objeto. Header file.
+ * @version 0.1
+ *
+ * Reemplaza a new/delete para los objetos que se crean y destruyen varias
+ * veces (por ejemplo el driver de un dispositivo que se conecta en
+ * caliente): la memoria se reserva al compilar, en el tamaño y la alineación
+ * justos, y el objeto se construye ahí con placement new, así el heap no se
+ * fragmenta.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __STATICSLOT_H__
+#define __STATICSLOT_H__
+
+#include <new>
+#include <stdint.h>
+#include <utility>
+
+/**
+ * @brief Lugar para un objeto de tipo T con construcción y destrucción
+ * explícitas
+ *
+ */
+template <typename T> class StaticSlot {
+private:
+  alignas(T) uint8_t _storage[sizeof(T)];
+  T *_object = nullptr;
+  uint32_t _constructions = 0;
+
+public:
+  /**
+   * @brief Construye el objeto (destruye antes el anterior, si había)
+   *
+   * @param args los argumentos del constructor de T
+   * @return T& el objeto construido
+   */
+  template <typename... Args> T &emplace(Args &&...args) {
+    this->reset();
+    _object = new (_storage) T(std::forward<Args>(args)...);
+    _constructions++;
+    return *_object;
+  }
+
+  /**
+   * @brief Destruye el objeto, si había uno
+   *
+   */
+  void reset() {
+    if (_object == nullptr) return;
+    _object->~T();
+    _object = nullptr;
+  }
+
+  T *get() const { return _object; }
+  T *operator->() const { return _object; }
+  T &operator*() const { return *_object; }
+  explicit operator bool() const { return _object != nullptr; }
+  // Cantidad de veces que se construyó el objeto
+  uint32_t constructions() const { return _constructions; }
+
+  StaticSlot() = default;
+  StaticSlot(const StaticSlot &) = delete;
+  StaticSlot &operator=(const StaticSlot &) = delete;
+  ~StaticSlot() { this->reset(); }
+};
+
+#endif // __STATICSLOT_H__
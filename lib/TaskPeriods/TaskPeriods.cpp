@@ -0,0 +1,127 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file TaskPeriods.cpp
+ * @brief Períodos de las tareas configurables en tiempo de ejecución. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "TaskPeriods.h"
+
+#include <stdio.h>
+#include <string.h>
+
+TaskPeriods::TaskPeriods(const TaskPeriod *table, uint8_t n)
+    : _table{table}, _n{n > TASK_PERIODS_MAX ? uint8_t(TASK_PERIODS_MAX) : n} {
+  this->reset();
+}
+
+/**
+ * @brief Busca una tarea por nombre
+ *
+ * @param name nombre (no necesita terminar en '\0')
+ * @param len largo del nombre
+ * @return int8_t índice en la tabla, -1 si no está
+ */
+int8_t TaskPeriods::find(const char *name, size_t len) const {
+  for (uint8_t i = 0; i < _n; i++) {
+    if (strlen(_table[i].name) == len and memcmp(_table[i].name, name, len) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Cambia el período de una tarea
+ *
+ * @param i índice en la tabla
+ * @param ms nuevo período
+ * @return false si está fuera de [min_ms, max_ms] (no se cambia)
+ */
+bool TaskPeriods::set(uint8_t i, uint32_t ms) {
+  if (i >= _n or ms < _table[i].min_ms or ms > _table[i].max_ms) return false;
+  _ms[i] = ms;
+  return true;
+}
+
+/**
+ * @brief Vuelve todos los períodos a su valor por defecto
+ *
+ */
+void TaskPeriods::reset() {
+  for (uint8_t i = 0; i < _n; i++) _ms[i] = _table[i].default_ms;
+}
+
+/**
+ * @brief Escribe los períodos que no están en su valor por defecto
+ *
+ * @param buf destino, termina en '\0'
+ * @param len tamaño de buf
+ * @return size_t largo del texto, 0 si no entraba (o no hay nada que guardar)
+ */
+size_t TaskPeriods::serialize(char *buf, size_t len) const {
+  size_t used = 0;
+  if (len > 0) buf[0] = '\0';
+  for (uint8_t i = 0; i < _n; i++) {
+    if (_ms[i] == _table[i].default_ms) continue;
+    int n = snprintf(buf + used, len - used, "%s=%lu\n", _table[i].name,
+                     (unsigned long)_ms[i]);
+    if (n < 0 or size_t(n) >= len - used) {
+      buf[0] = '\0';
+      return 0;
+    }
+    used += n;
+  }
+  return used;
+}
+
+/**
+ * @brief Aplica un texto con líneas nombre=ms
+ *
+ * Las líneas con una tarea desconocida o un valor fuera de los límites se
+ * ignoran (por ejemplo si cambió la tabla desde que se guardó).
+ *
+ * @param text texto (no necesita terminar en '\0')
+ * @param len largo del texto
+ * @return uint8_t cantidad de períodos aplicados
+ */
+uint8_t TaskPeriods::parse(const char *text, size_t len) {
+  uint8_t applied = 0;
+  const char *end = text + len;
+  while (text < end) {
+    const char *eol = static_cast<const char *>(memchr(text, '\n', end - text));
+    if (eol == nullptr) eol = end;
+    const char *eq = static_cast<const char *>(memchr(text, '=', eol - text));
+    if (eq != nullptr and eq + 1 < eol) {
+      uint64_t ms = 0;
+      bool digits = true;
+      for (const char *c = eq + 1; c < eol and digits; c++) {
+        digits = *c >= '0' and *c <= '9' and ms <= UINT32_MAX;
+        ms = ms * 10 + (*c - '0');
+      }
+      digits = digits and ms <= UINT32_MAX;
+      int8_t i = this->find(text, eq - text);
+      if (digits and i != -1 and this->set(i, uint32_t(ms))) applied++;
+    }
+    text = eol + 1;
+  }
+  return applied;
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file TaskPeriods.h
+ * @brief Períodos de las tareas configurables en tiempo de ejecución. Header file.
+ * @version 0.1
+ *
+ * Una tabla indica qué tareas se pueden configurar, con su período por
+ * defecto y los límites válidos. Los valores se guardan como texto, una
+ * línea nombre=ms por cada tarea que no esté en su valor por defecto, así
+ * el archivo es chico y sigue siendo válido si la tabla cambia.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __TASKPERIODS_H__
+#define __TASKPERIODS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Cantidad máxima de tareas en la tabla
+#ifndef TASK_PERIODS_MAX
+#define TASK_PERIODS_MAX 12
+#endif
+
+/**
+ * @brief Entrada de la tabla de tareas configurables
+ *
+ * self_timed indica que la tarea no usa un período fijo sino que se
+ * reprograma sola (con changeTicks()) a partir del valor configurado.
+ */
+struct TaskPeriod {
+  const char *name; // nombre de la tarea en el PeriodicTaskManager
+  uint32_t default_ms;
+  uint32_t min_ms;
+  uint32_t max_ms;
+  bool self_timed;
+};
+
+/**
+ * @brief Valores actuales de los períodos de una tabla de tareas
+ *
+ */
+class TaskPeriods {
+private:
+  const TaskPeriod *_table;
+  uint8_t _n;
+  uint32_t _ms[TASK_PERIODS_MAX];
+
+public:
+  int8_t find(const char *name, size_t len) const;
+  bool set(uint8_t i, uint32_t ms);
+  void reset();
+  size_t serialize(char *buf, size_t len) const;
+  uint8_t parse(const char *text, size_t len);
+  uint32_t get(uint8_t i) const { return i < _n ? _ms[i] : 0; }
+  const TaskPeriod &entry(uint8_t i) const { return _table[i]; }
+  uint8_t size() const { return _n; }
+
+  TaskPeriods(const TaskPeriod *table, uint8_t n);
+};
+
+#endif // __TASKPERIODS_H__
@@ -0,0 +1,75 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file WebAssetIndex.cpp
+ * @brief Búsqueda de los archivos embebidos y validación del caché. Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "WebAssetIndex.h"
+
+#include <string.h>
+
+/**
+ * @brief Busca el archivo de una ruta
+ *
+ * @param assets arreglo generado (WEB_ASSETS)
+ * @param n cantidad de archivos
+ * @param path ruta pedida, sin la query
+ * @return const WebAsset* el archivo, nullptr si no está embebido
+ */
+const WebAsset *findWebAsset(const WebAsset *assets, size_t n,
+                             const char *path) {
+  for (size_t i = 0; i < n; i++) {
+    if (not strcmp(assets[i].path, path)) return &assets[i];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Indica si el navegador ya tiene la versión actual de un archivo
+ *
+ * If-None-Match es una lista de ETags separados por comas, entre comillas y
+ * quizás débiles (W/"..."), o "*". Alcanza con que alguno sea el hash.
+ *
+ * @param if_none_match valor del encabezado
+ * @param hash hash del archivo (el ETag sin las comillas)
+ * @return true si corresponde responder 304
+ */
+bool etagMatches(const char *if_none_match, const char *hash) {
+  size_t hash_len = strlen(hash);
+  const char *p = if_none_match;
+  while (*p) {
+    while (*p == ' ' or *p == '\t' or *p == ',') p++;
+    if (*p == '*') return true;
+    if (p[0] == 'W' and p[1] == '/') p += 2;
+    if (*p == '"') {
+      const char *tag = ++p;
+      while (*p and *p != '"') p++;
+      if (*p != '"') return false; // sin la comilla de cierre
+      if (size_t(p - tag) == hash_len and not strncmp(tag, hash, hash_len))
+        return true;
+      p++;
+    } else {
+      while (*p and *p != ',') p++; // no es un ETag válido, se ignora
+    }
+  }
+  return false;
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file WebAssetIndex.h
+ * @brief Búsqueda de los archivos embebidos y validación del caché. Header file.
+ * @version 0.1
+ *
+ * La parte de lib/WebAssets que no depende del servidor web: qué archivo
+ * corresponde a una ruta y si el ETag que manda el navegador (If-None-Match)
+ * sigue siendo válido, así se puede probar en la PC.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __WEBASSETINDEX_H__
+#define __WEBASSETINDEX_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Un archivo embebido (contenido comprimido con gzip)
+ *
+ */
+struct WebAsset {
+  const char *path; // ruta en el servidor ("/index.html")
+  const char *type; // Content-Type
+  const char *hash; // hash del contenido, es el ETag y el ?v=
+  const uint8_t *data;
+  size_t len;
+};
+
+const WebAsset *findWebAsset(const WebAsset *assets, size_t n,
+                             const char *path);
+bool etagMatches(const char *if_none_match, const char *hash);
+
+#endif // __WEBASSETINDEX_H__
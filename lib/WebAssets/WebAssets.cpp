@@ -0,0 +1,60 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file WebAssets.cpp
+ * @brief Página web embebida en la flash (PROGMEM). Implementation file.
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "WebAssets.h"
+
+void sendWebAsset(AsyncWebServerRequest *request, const WebAsset &asset) {
+  String etag{"\"" + String(asset.hash) + "\""};
+  bool versioned = request->hasParam("v") and
+                   request->getParam("v")->value() == asset.hash;
+  const char *cache = versioned ? WEB_ASSET_IMMUTABLE : WEB_ASSET_REVALIDATE;
+  AsyncWebServerResponse *response;
+  if (request->hasHeader("If-None-Match") and
+      etagMatches(request->getHeader("If-None-Match")->value().c_str(),
+                  asset.hash)) {
+    response = request->beginResponse(304);
+  } else {
+    response = request->beginResponse_P(200, asset.type, asset.data, asset.len);
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", cache);
+  request->send(response);
+}
+
+void serveWebAssets(AsyncWebServer &server, const WebAsset *assets, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    const WebAsset *asset = &assets[i];
+    server.on(asset->path, HTTP_GET, [asset](AsyncWebServerRequest *request) {
+      sendWebAsset(request, *asset);
+    });
+  }
+  const WebAsset *index = findWebAsset(assets, n, "/index.html");
+  if (index != nullptr) {
+    server.on("/", HTTP_GET, [index](AsyncWebServerRequest *request) {
+      sendWebAsset(request, *index);
+    });
+  }
+}
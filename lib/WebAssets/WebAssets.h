@@ -0,0 +1,60 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+/**
+ * @file WebAssets.h
+ * @brief Página web embebida en la flash (PROGMEM). Header file.
+ * @version 0.1
+ *
+ * Los archivos los genera embed_assets.py (include/web_assets.h) ya
+ * comprimidos con gzip y con un hash de su contenido. Se sirven desde la
+ * flash sin pasar por el filesystem: con el ETag (el hash) el navegador
+ * revalida y recibe un 304 sin contenido, y los pedidos versionados
+ * (?v=<hash>, como los referencia el HTML generado) se marcan immutable.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __WEBASSETS_H__
+#define __WEBASSETS_H__
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <WebAssetIndex.h>
+
+// Cache-Control de los pedidos versionados (?v=<hash>) y de los demás
+#define WEB_ASSET_IMMUTABLE "public, max-age=31536000, immutable"
+#define WEB_ASSET_REVALIDATE "no-cache"
+
+/**
+ * @brief Registra un handler por archivo ("/index.html" también en "/")
+ *
+ * Hay que llamarla antes de serveStatic() para que tenga prioridad.
+ *
+ * @param server servidor web
+ * @param assets arreglo generado (WEB_ASSETS)
+ * @param n cantidad de archivos
+ */
+void serveWebAssets(AsyncWebServer &server, const WebAsset *assets, size_t n);
+
+/**
+ * @brief Responde un pedido con un archivo embebido (o un 304)
+ *
+ */
+void sendWebAsset(AsyncWebServerRequest *request, const WebAsset &asset);
+
+#endif // __WEBASSETS_H__
@@ -0,0 +1,92 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file WsCommand.cpp
+ * @brief Comandos del websocket. Implementation file.
+ * @version 0.2
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "WsCommand.h"
+
+#include <string.h>
+
+const char *const COMMAND_NAMES[CMD_COUNT]{"dat", "btn", "rgb", "lcd",
+                                           "sub", "uns", "prf", "bat",
+                                           "que", "his", "efx", "adc",
+                                           "cli", "mem", "cfg", "rep"};
+
+Command lookupCommand(const uint8_t *data, size_t len) {
+  if (len < COMMAND_CODE_LEN) return CMD_INVALID;
+  switch (opcode(data[0], data[1], data[2])) {
+  case opcode('d', 'a', 't'): return CMD_DAT;
+  case opcode('b', 't', 'n'): return CMD_BTN;
+  case opcode('r', 'g', 'b'): return CMD_RGB;
+  case opcode('l', 'c', 'd'): return CMD_LCD;
+  case opcode('s', 'u', 'b'): return CMD_SUB;
+  case opcode('u', 'n', 's'): return CMD_UNS;
+  case opcode('p', 'r', 'f'): return CMD_PRF;
+  case opcode('b', 'a', 't'): return CMD_BAT;
+  case opcode('q', 'u', 'e'): return CMD_QUE;
+  case opcode('h', 'i', 's'): return CMD_HIS;
+  case opcode('e', 'f', 'x'): return CMD_EFX;
+  case opcode('a', 'd', 'c'): return CMD_ADC;
+  case opcode('c', 'l', 'i'): return CMD_CLI;
+  case opcode('m', 'e', 'm'): return CMD_MEM;
+  case opcode('c', 'f', 'g'): return CMD_CFG;
+  case opcode('r', 'e', 'p'): return CMD_REP;
+  default: return CMD_INVALID;
+  }
+}
+
+bool commandReplies(Command cmd) {
+  switch (cmd) {
+  case CMD_BTN:
+  case CMD_RGB:
+  case CMD_LCD:
+  case CMD_SUB: // el estado llega después por la suscripción
+  case CMD_UNS: return false;
+  default: return true;
+  }
+}
+
+void MessageAssembler::reset() {
+  _len = 0;
+  _overflow = false;
+}
+
+MessageAssembler::Result MessageAssembler::feed(bool first_frame,
+                                                bool final_frame,
+                                                uint64_t index,
+                                                uint64_t frame_len,
+                                                const uint8_t *data,
+                                                size_t len) {
+  if (first_frame and index == 0) this->reset();
+  if (_overflow or _len + len > WS_MAX_MESSAGE) {
+    _overflow = true;
+  } else {
+    memcpy(_buf + _len, data, len);
+    _len += len;
+  }
+  if (not final_frame or index + len < frame_len) return INCOMPLETE;
+  Result result = _overflow ? TOO_LONG : COMPLETE;
+  if (_overflow) this->reset();
+  return result;
+}
@@ -0,0 +1,143 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file WsCommand.h
+ * @brief Comandos del websocket. Header file.
+ * @version 0.2
+ *
+ * Todos los comandos empiezan con un código de 3 caracteres, el resto del
+ * mensaje son los argumentos del comando (ver los comandos en main.cpp).
+ * Se trabaja directamente sobre los bytes recibidos, sin copiarlos a un
+ * String, y los mensajes fragmentados se rearman en un buffer acotado.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __WSCOMMAND_H__
+#define __WSCOMMAND_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Comandos válidos, en el mismo orden que COMMAND_NAMES
+ *
+ */
+enum Command : int8_t {
+  CMD_INVALID = -1,
+  CMD_DAT,
+  CMD_BTN,
+  CMD_RGB,
+  CMD_LCD,
+  CMD_SUB,
+  CMD_UNS,
+  CMD_PRF,
+  CMD_BAT,
+  CMD_QUE,
+  CMD_HIS,
+  CMD_EFX,
+  CMD_ADC,
+  CMD_CLI,
+  CMD_MEM,
+  CMD_CFG,
+  CMD_REP,
+  CMD_COUNT
+};
+
+// Largo del código de comando
+#define COMMAND_CODE_LEN 3
+// Separador de los comandos dentro de un lote ('bat')
+#define BATCH_SEPARATOR '\n'
+// Largo máximo de un mensaje fragmentado (los más largos se descartan)
+#ifndef WS_MAX_MESSAGE
+#define WS_MAX_MESSAGE 128
+#endif
+
+/**
+ * @brief Empaqueta el código de 3 caracteres en un entero
+ *
+ */
+constexpr uint32_t opcode(char a, char b, char c) {
+  return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 |
+         uint32_t(uint8_t(c)) << 16;
+}
+
+extern const char *const COMMAND_NAMES[CMD_COUNT];
+
+/**
+ * @brief Identifica el comando de un mensaje
+ *
+ * @param data mensaje recibido (no necesita terminar en '\0')
+ * @param len largo del mensaje
+ * @return Command el comando o CMD_INVALID si no es un comando conocido
+ */
+Command lookupCommand(const uint8_t *data, size_t len);
+
+/**
+ * @brief Indica si un comando responde con un mensaje propio
+ *
+ * Los que responden (consultas y los que devuelven su configuración) no se
+ * aceptan dentro de un lote, que se responde con un único mensaje.
+ *
+ * @param cmd comando
+ * @return true si el comando envía una respuesta
+ */
+bool commandReplies(Command cmd);
+
+/**
+ * @brief Rearma un mensaje del websocket que llega en varias partes
+ *
+ * Un mensaje puede llegar en varios frames (fragmentación del websocket) y
+ * cada frame en varios paquetes TCP. Se acumula todo en un buffer de
+ * WS_MAX_MESSAGE bytes; si no entra, se descarta el resto del mensaje y se
+ * informa una única vez al terminar.
+ */
+class MessageAssembler {
+public:
+  enum Result : uint8_t {
+    INCOMPLETE, // faltan partes del mensaje
+    COMPLETE,   // el mensaje está en data()/length()
+    TOO_LONG    // el mensaje terminó pero no entraba en el buffer
+  };
+
+private:
+  uint8_t _buf[WS_MAX_MESSAGE];
+  size_t _len = 0;
+  bool _overflow = false;
+
+public:
+  /**
+   * @brief Agrega una parte del mensaje (los campos de AwsFrameInfo)
+   *
+   * @param first_frame true si es el primer frame del mensaje (num == 0)
+   * @param final_frame true si es el último frame del mensaje (final)
+   * @param index posición de data dentro del frame
+   * @param frame_len largo total del frame
+   * @param data datos recibidos
+   * @param len largo de data
+   * @return Result si el mensaje está completo
+   */
+  Result feed(bool first_frame, bool final_frame, uint64_t index,
+              uint64_t frame_len, const uint8_t *data, size_t len);
+  const uint8_t *data() const { return _buf; }
+  size_t length() const { return _len; }
+  void reset();
+};
+
+#endif // __WSCOMMAND_H__
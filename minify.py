@@ -22,11 +22,7 @@ from csscompressor import compress as compress_css
 from rjsmin import jsmin as minify_js
 from htmlmin import minify as minify_html
 
-def minify_file(file_path, file_type):
-    # Leer contenido del archivo
-    with open(file_path, 'r') as f:
-        content = f.read()
-
+def minify_text(content, file_type):
     # Minificar según el tipo de archivo
     if file_type == 'css':
         minified_content = compress_css(content)
@@ -40,6 +36,13 @@ def minify_file(file_path, file_type):
 
     return minified_content
 
+def minify_file(file_path, file_type):
+    # Leer contenido del archivo
+    with open(file_path, 'r') as f:
+        content = f.read()
+
+    return minify_text(content, file_type)
+
 if __name__ == "__main__":
     if len(sys.argv) != 4:
         print("Usage: python minify.py <input_file> <output_file> <file_type>")
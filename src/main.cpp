@@ -16,15 +16,34 @@
 // along with esp8266-io-board-websocket.  If not, see
 // <https://www.gnu.org/licenses/>.
 
-#include <AHT10.h>
+#include <AdcPipeline.h>
 #include <Arduino.h>
-#include <BH1750.h>
+#include <BoardState.h>
+#include <ButtonEvents.h>
 #include <ESP8266WiFi.h>
 #include <ESPAsyncWebServer.h>
+#include <HeapMonitor.h>
+#include <I2CBusManager.h>
 #include <LiquidCrystal_I2C.h>
+#include <LcdFramebuffer.h>
 #include <LittleFS.h>
+#include <Metrics.h>
 #include <PeriodicTaskManager.h>
+#include <ReportFilter.h>
+#include <RgbEffects.h>
+#include <SensorHistory.h>
+#ifdef SENSOR_LOG
+#include <SensorLog.h>
+#endif
+#include <SpscQueue.h>
+#include <SplitPhaseSensor.h>
+#include <StatePush.h>
+#include <StaticSlot.h>
+#include <TaskPeriods.h>
+#include <WebAssets.h>
 #include <Wire.h>
+#include <WsCommand.h>
+#include <web_assets.h> // generado por embed_assets.py
 
 // El baudrate debe modifcarse en el platformio.ini
 #ifndef BAUD_RATE
@@ -36,61 +55,349 @@
 const int RGB[]{D7, D6, D5}; // R=D7, G=D6, B=D5
 const int BTNS[]{D3, D4};    // BTN1=D3, BTN2=D4
 
-// Semi-ciclo de un SENO con 128 posiciones
-const uint8_t SINE_LUT[] = {
-    0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x02, 0x02, 0x03, 0x04, 0x05,
-    0x05, 0x06, 0x07, 0x09, 0x0A, 0x0B, 0x0C, 0x0E, 0x0F, 0x11, 0x12, 0x14,
-    0x15, 0x17, 0x19, 0x1B, 0x1D, 0x1F, 0x21, 0x23, 0x25, 0x28, 0x2A, 0x2C,
-    0x2F, 0x31, 0x34, 0x36, 0x39, 0x3B, 0x3E, 0x41, 0x43, 0x46, 0x49, 0x4C,
-    0x4F, 0x52, 0x55, 0x58, 0x5A, 0x5D, 0x61, 0x64, 0x67, 0x6A, 0x6D, 0x70,
-    0x73, 0x76, 0x79, 0x7C, 0x80, 0x83, 0x86, 0x89, 0x8C, 0x8F, 0x92, 0x95,
-    0x98, 0x9B, 0x9E, 0xA2, 0xA5, 0xA7, 0xAA, 0xAD, 0xB0, 0xB3, 0xB6, 0xB9,
-    0xBC, 0xBE, 0xC1, 0xC4, 0xC6, 0xC9, 0xCB, 0xCE, 0xD0, 0xD3, 0xD5, 0xD7,
-    0xDA, 0xDC, 0xDE, 0xE0, 0xE2, 0xE4, 0xE6, 0xE8, 0xEA, 0xEB, 0xED, 0xEE,
-    0xF0, 0xF1, 0xF3, 0xF4, 0xF5, 0xF6, 0xF8, 0xF9, 0xFA, 0xFA, 0xFB, 0xFC,
-    0xFD, 0xFD, 0xFE, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF};
-
 /* Información para conectarse al WiFi (Modo AP) */
 const char *SSID{"ESP8266 IO Board"};
 const char *PSWD{"asdf1234"};
 // Mensaje que se envía cuando llega un comando que no está en la lista
 // ver onWebSocketEvent()
 const char *BADREQ{"{\"error\": \"No es un comando válido.\"}"};
+const char *BUSY{"{\"error\": \"Cola de comandos llena.\"}"};
 
 // Variables del servidor y websocket
 AsyncWebServer server{80};
 AsyncWebSocket ws{"/ws"};
 
 /* Periféricos y uso interno: */
-LiquidCrystal_I2C *lcd{nullptr};
+// El driver del LCD se construye en memoria estática cada vez que se
+// conecta (sin new/delete, para no fragmentar el heap)
+StaticSlot<LiquidCrystal_I2C> lcd{};
 const uint8_t LCD_ADDRSS[]{0x3F, 0x27}; // posibles direcciones para el LCD
-volatile bool is_lcd_connected{false};
 // Textos en el display (fila 1 y fila 2)
-String lcdrows[2]{"", ""};
+char lcdrows[2][BOARD_LCD_COLS + 1]{"", ""};
+// Lo que se muestra en el display: los comandos solo escriben acá y una
+// tarea envía las celdas que cambiaron (a lo sumo LCD_CELLS_PER_FRAME por
+// cuadro, un cuadro cada LCD_FRAME_MS)
+LcdFramebuffer lcd_fb{};
+#ifndef LCD_FRAME_MS
+#define LCD_FRAME_MS 50
+#endif
+#ifndef LCD_CELLS_PER_FRAME
+#define LCD_CELLS_PER_FRAME 8
+#endif
 
-AHT10 *aht10{nullptr};
-volatile bool is_aht_connected{false};
+// Los sensores se leen en dos fases (disparo y lectura) sin bloquear el loop
+AHT10Sensor aht10{};
+const uint8_t AHT10_ADDRSS[]{AHT10Sensor::ADDRESS};
+const uint32_t AHT10_PERIOD_MS{500}; // período de lectura
+// Valores publicados a los clientes (con banda muerta, ver report_filters)
 volatile float tmp{0};
 volatile float hum{0};
+// Última lectura, la que guardan el historial y el log
+volatile float tmp_raw{0};
+volatile float hum_raw{0};
 
-BH1750 *bh1750{nullptr};
-const uint8_t BH1750ADDR{0x23};
-volatile bool is_bh_connected{false};
-volatile float lx{0};
+BH1750Sensor bh1750{};
+const uint8_t BH1750_ADDRSS[]{BH1750Sensor::ADDRESS};
+const uint32_t BH1750_PERIOD_MS{200}; // período de lectura
+volatile float lx{0};     // publicado
+volatile float lx_raw{0}; // última lectura
 
 // Tareas periódicas:
 PeriodicTaskManager pTasker;
+TaskHandle rgb_task{}; // se pausa/reanuda desde los comandos y los botones
+
+// Períodos configurables (comando cfg), ver TASK_PERIODS. Las lecturas de
+// los sensores se reprograman solas con el período de su índice
+enum PeriodId : uint8_t { PERIOD_AHT, PERIOD_BH };
+extern TaskPeriods task_periods;
+
+// Dispositivos del bus I2C, en el orden de la tabla I2C_DRIVERS
+enum I2CDevice : uint8_t { DEV_LCD, DEV_AHT10, DEV_BH1750, DEV_COUNT };
+extern const I2CDriver I2C_DRIVERS[DEV_COUNT];
+I2CBusManager i2c{pTasker, I2C_DRIVERS, DEV_COUNT};
 
 // Último estado del botón registrado (presionado/no-presionado)[ON/OFF]
 volatile bool last_btn_states[LEN(BTNS)]{};
-// Valor del RGB en formato '#RRGGBB'
-String rgb_value{};
+/* LED RGB (ver lib/RgbEffects) */
+// Cada cuánto (ms) se recalcula el color del efecto
+#ifndef RGB_FRAME_MS
+#define RGB_FRAME_MS 20
+#endif
+// Duración (ms) de un ciclo del efecto al arrancar
+#ifndef RGB_PERIOD_MS
+#define RGB_PERIOD_MS 36000
+#endif
+RgbEffects rgb_fx{EFFECT_FADE, 0x000000, RGB_PERIOD_MS};
 
-// Valor del LDR en la placa
+/* LDR: se toman LDR_OVERSAMPLE muestras espaciadas por cada valor, que se
+   filtra (ver lib/AdcPipeline y el comando adc) */
+// Cada cuánto (ms) se toma una muestra del ADC
+#ifndef LDR_SAMPLE_MS
+#define LDR_SAMPLE_MS 16
+#endif
+// Muestras por valor (un valor cada LDR_SAMPLE_MS * LDR_OVERSAMPLE ms)
+#ifndef LDR_OVERSAMPLE
+#define LDR_OVERSAMPLE 8
+#endif
+// Filtro al arrancar: IIR con alfa 1/4
+#ifndef LDR_FILTER
+#define LDR_FILTER ADC_FILTER_IIR
+#endif
+#ifndef LDR_FILTER_PARAM
+#define LDR_FILTER_PARAM 2
+#endif
+AdcPipeline ldr{LDR_OVERSAMPLE, LDR_FILTER, LDR_FILTER_PARAM};
+
+// Valor del LDR en la placa (filtrado)
 volatile uint16_t lrd_value = 0;
 
+/* Reporte por excepción: tmp, hum, lx y lrd_value (lo que se envía a los
+   clientes) solo cambian cuando la lectura se aleja del último valor
+   reportado más que la banda muerta, o pasado el intervalo máximo (ver el
+   comando rep). El historial y el log usan las lecturas sin filtrar. */
+enum SensorId : uint8_t { SENSOR_TMP, SENSOR_HUM, SENSOR_LX, SENSOR_LDR, SENSOR_COUNT };
+const char *const SENSOR_NAMES[SENSOR_COUNT]{"tmp", "hum", "lx", "ldr"};
+ReportFilter report_filters[SENSOR_COUNT]{
+    ReportPolicy{0.1f, false, 1000, 60000}, // °C
+    ReportPolicy{0.5f, false, 1000, 60000}, // %
+    ReportPolicy{5, true, 200, 60000},      // 5% del valor en lx
+    ReportPolicy{4, false, 100, 30000},     // cuentas del ADC
+};
+// Muestreo adaptivo de los sensores I2C: el período se duplica cada
+// SAMPLE_STABLE_COUNT lecturas quietas, hasta 2^SAMPLE_MAX_SHIFT veces el
+// configurado (cfg), sin pasar el intervalo máximo de reporte, y vuelve a
+// él apenas la señal se mueve
+#ifndef SAMPLE_MAX_SHIFT
+#define SAMPLE_MAX_SHIFT 3
+#endif
+#ifndef SAMPLE_STABLE_COUNT
+#define SAMPLE_STABLE_COUNT 4
+#endif
+AdaptivePeriod aht_rate{SAMPLE_MAX_SHIFT, SAMPLE_STABLE_COUNT};
+AdaptivePeriod bh_rate{SAMPLE_MAX_SHIFT, SAMPLE_STABLE_COUNT};
+
 // Indica si el botón está presionado desde el cliente web
 volatile bool is_webbtn_pressed[LEN(BTNS)]{};
+static_assert(LEN(BTNS) == BOARD_BTNS, "BOARD_BTNS debe coincidir con BTNS");
+
+#ifndef BTN_POLLING
+/* Botones por interrupción (ver lib/ButtonEvents): la ISR encola cada flanco
+   con su micros() y loop() hace el antirrebote. Con -D BTN_POLLING se vuelve
+   a leerlos cada 4 ms (readBtns()). */
+// Ventana de antirrebote (µs que el pin tiene que quedar quieto)
+#ifndef BTN_DEBOUNCE_US
+#define BTN_DEBOUNCE_US 5000
+#endif
+// Flancos que se pueden encolar (potencia de 2)
+#ifndef BTN_EDGE_QUEUE
+#define BTN_EDGE_QUEUE 16
+#endif
+SpscQueue<ButtonEdge, BTN_EDGE_QUEUE> btn_edges{};
+EdgeDebouncer btn_debouncer{LEN(BTNS), BTN_DEBOUNCE_US};
+// Flancos perdidos (cola llena) ya atendidos, ver serviceButtons()
+uint32_t btn_overflows_seen{0};
+#endif
+
+/* Envío del estado por suscripción (push) */
+// Cantidad máxima de clientes, a los que se conectan de más se los cierra
+#ifndef MAX_WS_CLIENTS
+#define MAX_WS_CLIENTS 4
+#endif
+// Mensajes encolados en un cliente a partir de los cuales se le retiene el
+// estado (recibe solo el último cuando se desagota) y se le descartan los
+// eventos, así la memoria que ocupa cada cliente lento queda acotada
+#ifndef WS_CLIENT_QUEUE_SOFT
+#define WS_CLIENT_QUEUE_SOFT 2
+#endif
+#ifndef WS_CLIENT_QUEUE_HARD
+#define WS_CLIENT_QUEUE_HARD 6
+#endif
+// Ventana (ms) en la que se agrupan los cambios antes de enviarlos
+#ifndef PUSH_WINDOW_MS
+#define PUSH_WINDOW_MS 20
+#endif
+// Si no hubo cambios, cada cuánto (ms) se reenvía el estado (keepalive)
+#ifndef PUSH_KEEPALIVE_MS
+#define PUSH_KEEPALIVE_MS 5000
+#endif
+
+// Datos de cada cliente conectado al websocket (id == 0 es un lugar libre)
+struct WsClientSlot {
+  uint32_t id;
+  bool subscribed;
+  bool binary; // usa el protocolo binario (se conectó a /ws?proto=bin)
+  MessageAssembler message; // rearma los mensajes fragmentados
+  int8_t history_level;  // nivel del historial que se está enviando (-1 ninguno)
+  uint32_t history_seq;  // próximo punto del historial a enviar
+  StateBacklog push;     // estado retenido por tener la cola llena
+  uint32_t dropped;      // eventos descartados por tener la cola llena
+  uint16_t max_queue;    // máxima cantidad de mensajes encolados vista
+};
+WsClientSlot ws_clients[MAX_WS_CLIENTS]{};
+// Conexiones rechazadas por superar MAX_WS_CLIENTS
+uint32_t ws_rejected{0};
+
+/**
+ * @brief Indica si se le puede encolar un mensaje más a un cliente
+ *
+ * @param slot lugar del cliente en ws_clients (registra la cola máxima)
+ * @param client el cliente
+ * @param limit cantidad de mensajes encolados a partir de la cual no
+ * @return true si tiene menos de limit mensajes encolados
+ */
+bool clientHasRoom(WsClientSlot &slot, AsyncWebSocketClient *client,
+                   size_t limit) {
+  size_t queued{client->queueLen()};
+  if (queued > slot.max_queue) slot.max_queue = queued;
+  return queued < limit && client->canSend();
+}
+
+/* Contadores de /metrics: enteros fijos que solo se incrementan */
+struct WsTraffic {
+  uint32_t frames;
+  uint32_t bytes;
+};
+// Tipos de mensaje saliente: las respuestas se cuentan por comando y además
+// el estado, los eventos y los errores
+enum WsOutKind : uint8_t {
+  OUT_STATE = CMD_COUNT,
+  OUT_EVENT,
+  OUT_ERROR,
+  OUT_COUNT
+};
+WsTraffic ws_in[CMD_COUNT]{};
+WsTraffic ws_out[OUT_COUNT]{};
+uint32_t ws_badreq{0};
+// Comando que se está ejecutando (las respuestas se cuentan a su nombre)
+Command current_command{CMD_INVALID};
+// Vueltas de loop() en total y en el último segundo
+uint32_t loop_iterations{0};
+uint32_t loop_rate{0};
+
+/**
+ * @brief Cuenta un mensaje saliente
+ *
+ * @param kind Command o WsOutKind
+ * @param len bytes del mensaje
+ */
+void countOut(uint8_t kind, size_t len) {
+  ws_out[kind].frames++;
+  ws_out[kind].bytes += len;
+}
+
+/**
+ * @brief Envía un texto a un cliente y lo cuenta
+ *
+ * @param client destino
+ * @param text mensaje
+ * @param kind Command o WsOutKind
+ */
+void sendText(AsyncWebSocketClient *client, const char *text, uint8_t kind) {
+  countOut(kind, strlen(text));
+  client->text(text);
+}
+
+/**
+ * @brief Responde al comando que se está ejecutando
+ *
+ * @param client destino
+ * @param json respuesta
+ */
+void replyText(AsyncWebSocketClient *client, const char *json) {
+  sendText(client, json,
+           current_command == CMD_INVALID ? uint8_t(OUT_ERROR)
+                                          : uint8_t(current_command));
+}
+
+/* Historial de los sensores (ver lib/SensorHistory) */
+// Cada cuánto (ms) se toma una muestra cruda
+#ifndef HISTORY_RAW_MS
+#define HISTORY_RAW_MS 250
+#endif
+// Puntos por mensaje al enviar el historial, y cada cuánto (ms) se envía uno
+#ifndef HISTORY_CHUNK
+#define HISTORY_CHUNK 8
+#endif
+#ifndef HISTORY_TX_MS
+#define HISTORY_TX_MS 50
+#endif
+// Canales: temperatura y humedad en centésimas, luz en lx y el LDR crudo
+const char *const HISTORY_NAMES[HISTORY_CHANNELS]{"tmp", "hum", "lx", "ldr"};
+SensorHistory history{HISTORY_RAW_MS};
+
+#ifdef SENSOR_LOG
+/* Log persistente de los sensores en LittleFS (ver lib/SensorLog) */
+// Cada cuánto (ms) se agrega un registro; se escriben de a LOG_BATCH
+#ifndef LOG_SAMPLE_MS
+#define LOG_SAMPLE_MS 10000
+#endif
+static_assert(LOG_CHANNELS == HISTORY_CHANNELS,
+              "el log guarda los mismos canales que el historial");
+SensorLog sensor_log{LittleFS, "/log"};
+#endif
+
+/* Uso del heap: una muestra cada HEAP_SAMPLE_MS y un historial con el
+   peor valor de cada HEAP_GROUP muestras (por defecto 1 min, 1 h en total) */
+#ifndef HEAP_SAMPLE_MS
+#define HEAP_SAMPLE_MS 1000
+#endif
+#ifndef HEAP_GROUP
+#define HEAP_GROUP 60
+#endif
+HeapMonitor heap_monitor{HEAP_GROUP};
+
+/* Períodos de las tareas que se pueden cambiar con el comando cfg, con sus
+   límites. Los que no están en su valor por defecto se guardan en
+   TASK_PERIODS_FILE y se cargan al arrancar. */
+#define TASK_PERIODS_FILE "/tasks.cfg"
+const TaskPeriod TASK_PERIODS[]{
+    // primero las que se reprograman solas, en el orden de PeriodId
+    {"aht", AHT10_PERIOD_MS, 100, 60000, true},
+    {"bh", BH1750_PERIOD_MS, 200, 60000, true},
+    {"lcd", LCD_FRAME_MS, 20, 1000, false},
+    {"rgb", RGB_FRAME_MS, 10, 1000, false},
+    {"ldr", LDR_SAMPLE_MS, 2, 1000, false},
+    {"push", PUSH_WINDOW_MS, 10, 1000, false},
+    {"his-tx", HISTORY_TX_MS, 10, 1000, false},
+#ifdef BTN_POLLING
+    {"btns", 4, 1, 50, false},
+#endif
+#ifdef SENSOR_LOG
+    {"log", LOG_SAMPLE_MS, 1000, 3600000, false},
+#endif
+};
+TaskPeriods task_periods{TASK_PERIODS, LEN(TASK_PERIODS)};
+
+// Estado serializado compartido por todos los clientes: cada versión del
+// estado se serializa una sola vez en un único buffer del websocket
+struct SharedSnapshot {
+  BoardState state;
+  uint32_t version;
+  AsyncWebSocketMessageBuffer *json;
+  AsyncWebSocketMessageBuffer *binary;
+};
+SharedSnapshot snapshot{};
+
+/* Cola de comandos: el websocket (contexto de red) solo identifica el
+   comando y lo encola, loop() los ejecuta. Así el estado compartido (RGB,
+   LCD, tareas) solo se modifica desde loop(). */
+// Cantidad de comandos en espera (potencia de 2)
+#ifndef CMD_QUEUE_LEN
+#define CMD_QUEUE_LEN 8
+#endif
+// Cantidad máxima de comandos que se ejecutan por cada vuelta del loop()
+#ifndef CMD_DRAIN_MAX
+#define CMD_DRAIN_MAX 4
+#endif
+struct QueuedCommand {
+  Command cmd;
+  uint32_t client_id;
+  uint16_t len;
+  char args[WS_MAX_MESSAGE - COMMAND_CODE_LEN]; // un lote entra completo
+};
+SpscQueue<QueuedCommand, CMD_QUEUE_LEN> command_queue{};
+// Comandos descartados porque el cliente se desconectó antes de ejecutarlos
+uint32_t commands_dropped{0};
 
 /**
  * @brief Se utiliza para leer el estado de los BTNS
@@ -112,163 +419,366 @@ int readBtnFrom(uint8_t pin) {
 }
 
 /**
- * @brief Lee el valor del LDR asociado al ADC
+ * @brief Pasa una lectura por el filtro de reporte de su sensor
+ *
+ * @param sensor cuál es
+ * @param value la lectura
+ * @return true si se reporta (hay que actualizar el valor publicado)
+ */
+bool reportSample(SensorId sensor, float value) {
+  return report_filters[sensor].offer(value, millis());
+}
+
+/**
+ * @brief Intervalo máximo de reporte más corto entre dos sensores
+ *
+ * @param a sensor
+ * @param b sensor
+ * @return uint32_t ms, 0 si ninguno tiene reporte forzado
+ */
+uint32_t maxReportInterval(SensorId a, SensorId b) {
+  uint32_t ia{report_filters[a].policy().max_interval_ms};
+  uint32_t ib{report_filters[b].policy().max_interval_ms};
+  if (ia == 0 || (ib != 0 && ib < ia)) return ib;
+  return ia;
+}
+
+/**
+ * @brief Período de muestreo actual del AHT10 (adaptivo)
+ *
+ */
+uint32_t ahtPeriod() {
+  return aht_rate.period(task_periods.get(PERIOD_AHT),
+                         maxReportInterval(SENSOR_TMP, SENSOR_HUM));
+}
+
+/**
+ * @brief Período de muestreo actual del BH1750 (adaptivo)
+ *
+ */
+uint32_t bhPeriod() {
+  return bh_rate.period(task_periods.get(PERIOD_BH),
+                        report_filters[SENSOR_LX].policy().max_interval_ms);
+}
+
+/**
+ * @brief Toma una muestra del LDR asociado al ADC
+ *
+ * Cada LDR_OVERSAMPLE muestras se actualiza lrd_value con el valor filtrado
+ * (si se aleja lo suficiente del último reportado).
  *
  * @param id designado por el PeriodicTaskManager
  */
-void readLDR(uint8_t id __unused) { lrd_value = analogRead(A0); }
+void readLDR(uint8_t id __unused) {
+  if (ldr.add(analogRead(A0)) && reportSample(SENSOR_LDR, ldr.value())) {
+    lrd_value = ldr.value();
+  }
+}
 
 /**
  * @brief Lectura de temperatura y humedad
  *
+ * Se alterna entre disparar la conversión y leerla (una misma conversión
+ * entrega ambos valores), la tarea se vuelve a agendar para cuando termina
+ * la conversión y luego para completar el período.
+ *
  * @param id designado por el PeriodicTaskManager
  */
 void readAHT10(uint8_t id __unused) {
-  if (is_aht_connected) {
-    float t = aht10->readTemperature();
-    float h = aht10->readHumidity();
-    if (t != AHT10_ERROR) {
-      tmp = t;
-    }
-    if (h != AHT10_ERROR) {
-      hum = h;
-    }
+  uint32_t errors{aht10.errors()};
+  pTasker.changeTicks(i2c.readTask(DEV_AHT10), aht10.step(ahtPeriod()));
+  if (aht10.takeReading()) {
+    tmp_raw = aht10.temperature();
+    hum_raw = aht10.humidity();
+    if (reportSample(SENSOR_TMP, tmp_raw)) tmp = tmp_raw;
+    if (reportSample(SENSOR_HUM, hum_raw)) hum = hum_raw;
+    aht_rate.update(report_filters[SENSOR_TMP].moving() ||
+                    report_filters[SENSOR_HUM].moving());
+  } else if (aht10.errors() != errors) {
+    i2c.reprobe(); // puede que se haya desconectado
   }
 }
 
 /**
  * @brief Lectura del luxómetro
  *
+ * Igual que readAHT10(), en dos fases con una medición por vez.
+ *
  * @param id designado por el PeriodicTaskManager
  */
 void readBH1750(uint8_t id __unused) {
-  if (is_bh_connected) {
-    if (bh1750->measurementReady()) {
-      float l = bh1750->readLightLevel();
-      if (l > 0) {
-        lx = l;
-      }
-    }
+  uint32_t errors{bh1750.errors()};
+  pTasker.changeTicks(i2c.readTask(DEV_BH1750), bh1750.step(bhPeriod()));
+  if (bh1750.takeReading()) {
+    lx_raw = bh1750.lux();
+    if (reportSample(SENSOR_LX, lx_raw)) lx = lx_raw;
+    bh_rate.update(report_filters[SENSOR_LX].moving());
+  } else if (bh1750.errors() != errors) {
+    i2c.reprobe(); // puede que se haya desconectado
   }
 }
 
 /**
- * @brief Verifica si hay un dispositivo conectado en el BUS I2C
+ * @brief Indica si el LCD sigue respondiendo en address
  *
- * Envía un paquete a la dirección address, si el dispositivo
- * contesta, entonces devuelve un true, sino false.
- *
- * @param address dirección a verificar
- * @return true si se encuentra en la linea del I2C
- * @return false si no se encuentra en la linea del I2C
+ * LiquidCrystal_I2C descarta el resultado de endTransmission(), por eso se
+ * sondea la dirección del expander después de escribirle.
  */
-bool isI2CDevicePresent(byte address) {
+bool lcdAcks(uint8_t address) {
   Wire.beginTransmission(address);
-  byte error = Wire.endTransmission();
-  return (error == 0); // Devuelve true si no hay error (dispositivo presente)
+  return Wire.endTransmission() == 0;
 }
 
 /**
- * @brief Verifica que el LCD esté conectado y lo inicializa
- *
- * Cuando encuentra que se conectó un nuevo lcd (o el mismo), lo inicializa
- * soporta un único LCD conectado a la vez.
+ * @brief El LCD visto desde el framebuffer: write() devuelve 0 si el
+ * expander dejó de responder
  *
- * @param id no utilizado, pid que le otorga el PeriodicTaskManager
  */
-void initLCD(uint8_t id __unused) {
-  static uint8_t last_addr{0};
-  uint8_t conn_addr{0};
-  for (auto &addr : LCD_ADDRSS) {
-    if (isI2CDevicePresent(addr)) {
-      conn_addr = addr;
-      break;
-    }
+struct LcdBus {
+  uint8_t address;
+  void setCursor(uint8_t col, uint8_t row) { lcd->setCursor(col, row); }
+  size_t write(uint8_t ch) {
+    lcd->write(ch);
+    return lcdAcks(address) ? 1 : 0;
   }
-  is_lcd_connected = conn_addr != 0;
+};
 
-  if (last_addr != conn_addr && is_lcd_connected) {
-    if (lcd != nullptr) { // no hay problema al hacer delete
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
-      delete lcd;
-#pragma GCC diagnostic pop
-    }
-    lcd = new LiquidCrystal_I2C{conn_addr, 16, 2};
-    lcd->init();
-    lcd->backlight();
-    // Se escribe el último texto enviado:
-    lcd->print(lcdrows[0]);
-    lcd->setCursor(0, 1);
-    lcd->print(lcdrows[1]);
-  }
-  last_addr = conn_addr;
+/**
+ * @brief Inicializa el LCD encontrado en address
+ *
+ * Soporta un único LCD conectado a la vez, al conectarse renderLCD()
+ * redibuja el último texto enviado.
+ *
+ * @param address dirección en la que respondió el LCD
+ * @return true si el expander respondió después de inicializarlo
+ */
+bool initLCD(uint8_t address) {
+  lcd.emplace(address, 16, 2);
+  lcd->init();
+  lcd->backlight();
+  lcd_fb.reset(); // init() deja el display en blanco
+  return lcdAcks(address);
+}
+
+/**
+ * @brief Envía al LCD las celdas del framebuffer que cambiaron
+ *
+ * Si una escritura falla el LCD se da por desconectado sin esperar al
+ * próximo sondeo (que con el backoff puede tardar segundos): al volver se
+ * reinicializa y se redibuja todo.
+ *
+ * @param id no se utiliza, es el id del proceso periódico.
+ */
+void renderLCD(uint8_t id __unused) {
+  uint32_t errors{lcd_fb.errors()};
+  LcdBus bus{i2c.address(DEV_LCD)};
+  lcd_fb.render(bus, LCD_CELLS_PER_FRAME);
+  if (lcd_fb.errors() != errors) i2c.lost(DEV_LCD);
+}
+
+/**
+ * @brief Destruye el driver del LCD cuando se desconecta
+ *
+ */
+void teardownLCD() {
+  lcd.reset();
+  lcd_fb.invalidate();
 }
 
 /**
  * @brief Inicializa el sensor de temperatura y humedad i2c
  *
- * Cuando se conecta el AHT10 se inicializa y se detecta si
- * fue desconectado, desalocando la memoria. Aparece y desaparece
- * de la interfaz gráfica web según corresponde.
+ * @param address no se utiliza, el AHT10 tiene una sola dirección
+ * @return true si el sensor aceptó el comando de inicialización
+ */
+bool initAHT10(uint8_t address __unused) { return aht10.begin(); }
+
+/**
+ * @brief Descarta la conversión en curso cuando se desconecta el AHT10
+ *
+ */
+void teardownAHT10() {
+  aht10.reset();
+  // al reconectarse se reporta la primera lectura, con el período base
+  report_filters[SENSOR_TMP].reset();
+  report_filters[SENSOR_HUM].reset();
+  aht_rate.update(true);
+}
+
+/**
+ * @brief Inicializa el sensor de luz i2c (luxómetro)
+ *
+ * @param address no se utiliza, el BH1750 se usa en su dirección por defecto
+ * @return true si el sensor aceptó el comando de encendido
+ */
+bool initBH1750(uint8_t address __unused) { return bh1750.begin(); }
+
+/**
+ * @brief Descarta la medición en curso cuando se desconecta el BH1750
+ *
+ */
+void teardownBH1750() {
+  bh1750.reset();
+  report_filters[SENSOR_LX].reset();
+  bh_rate.update(true);
+}
+
+// Tabla de drivers I2C (en el orden de I2CDevice): agregar un dispositivo
+// es agregar una entrada. Las tareas de lectura (o de dibujo, en el LCD)
+// solo corren mientras el dispositivo está conectado. El AHT10 se lee cada 500 ms y el luxómetro
+// cada 200 ms (una lectura en alta resolución tarda hasta 180ms), cada
+// lectura se dispara y se recoge en dos ejecuciones de la misma tarea.
+const I2CDriver I2C_DRIVERS[DEV_COUNT]{
+    {"lcd", LCD_ADDRSS, LEN(LCD_ADDRSS), initLCD, teardownLCD, renderLCD,
+     LCD_FRAME_MS, OverrunPolicy::SKIP},
+    {"aht", AHT10_ADDRSS, LEN(AHT10_ADDRSS), initAHT10, teardownAHT10,
+     readAHT10, AHT10_PERIOD_MS, OverrunPolicy::FROM_COMPLETION},
+    {"bh", BH1750_ADDRSS, LEN(BH1750_ADDRSS), initBH1750, teardownBH1750,
+     readBH1750, BH1750_PERIOD_MS, OverrunPolicy::FROM_COMPLETION},
+};
+
+/**
+ * @brief Sondea el bus I2C buscando dispositivos conectados o desconectados
+ *
+ * Corre cada I2C_PROBE_MIN_MS, pero el I2CBusManager solo sondea cuando
+ * vence su intervalo (que crece mientras no hay cambios).
  *
  * @param id no se utiliza, es el id del proceso periódico.
  */
-void initAHT10(uint8_t id __unused) {
-  if (isI2CDevicePresent(AHT10_ADDRESS_0X38)) {
-    if (aht10 == nullptr) {
-      aht10 = new AHT10(AHT10_ADDRESS_0X38);
-      is_aht_connected = aht10->begin();
-      if (!is_aht_connected) {
-        delete aht10;
-        aht10 = nullptr; // Se vuelve a nullptr sino queda el valor anterior
-      }
-    }
+void scanI2C(uint8_t id __unused) { i2c.refresh(); }
+
+/**
+ * @brief Avanza el efecto del LED RGB y actualiza el PWM si el color cambió
+ *
+ * La corrección gamma se aplica solo a la salida, el color que se informa a
+ * los clientes es el del efecto.
+ *
+ * @param id asignado por el PerdiodicTaskManager, no se utiliza.
+ */
+void renderRGB(uint8_t id __unused) {
+  static uint32_t written{UINT32_MAX};
+  uint32_t color{rgb_fx.update(millis())};
+  if (color == written) return;
+  written = color;
+  for (uint8_t c{0}; c < LEN(RGB); c++) {
+    analogWrite(RGB[c], 255 - RgbEffects::gamma(channel(color, c)));
+  }
+}
+
+/**
+ * @brief Cambia el efecto del LED RGB
+ *
+ * El efecto estático no necesita recalcularse: se pausa la tarea.
+ *
+ * @param effect el nuevo efecto
+ */
+void setRGBEffect(RgbEffect effect) {
+  rgb_fx.setEffect(effect);
+  if (!rgb_fx.animated()) {
+    pTasker.pause(rgb_task);
   } else {
-    is_aht_connected = false;
-    if (aht10 != nullptr) {
-      delete aht10;
-      aht10 = nullptr; // Se vuelve a nullptr sino queda el valor anterior
-    }
+    pTasker.unpause(rgb_task);
   }
+  renderRGB(0);
 }
 
 /**
- * @brief Inicializa el sensor de luz i2c (luxómetro)
+ * @brief Avisa a los clientes suscriptos que cambió un botón
  *
- * Cuando se conecta el BH1750 se inicializa y se detecta si
- * fue desconectado, desalocando la memoria. Aparece y desaparece
- * de la interfaz gráfica web según corresponde.
+ * Se envía en el momento, sin esperar a pushState():
+ * {"evt":"btn","btn":N,"pressed":0/1,"us":micros() del flanco}
  *
- * @param id no se utiliza, es el id del proceso periódico.
+ * @param i índice del botón en BTNS
+ * @param pressed si quedó presionado
+ * @param us micros() del cambio
  */
-void initBH1750(uint8_t id __unused) {
-  if (isI2CDevicePresent(BH1750ADDR)) {
-    if (bh1750 == nullptr) {
-      bh1750 = new BH1750(BH1750ADDR);
-      is_bh_connected = bh1750->begin(BH1750::CONTINUOUS_HIGH_RES_MODE);
-      if (!is_bh_connected) {
-        delete bh1750;
-        bh1750 = nullptr; // Se vuelve a nullptr sino queda el valor anterior
-      }
+void sendButtonEvent(size_t i, bool pressed, uint32_t us) {
+  char json[64];
+  snprintf(json, sizeof(json),
+           "{\"evt\":\"btn\",\"btn\":%u,\"pressed\":%u,\"us\":%u}",
+           unsigned(i + 1), unsigned(pressed), unsigned(us));
+  for (auto &slot : ws_clients) {
+    if (slot.id == 0 || !slot.subscribed) continue;
+    AsyncWebSocketClient *client{ws.client(slot.id)};
+    if (client == nullptr) continue;
+    if (clientHasRoom(slot, client, WS_CLIENT_QUEUE_HARD)) {
+      sendText(client, json, OUT_EVENT);
+    } else {
+      slot.dropped++;
     }
-  } else {
-    is_bh_connected = false;
-    if (bh1750 != nullptr) {
-      delete bh1750;
-      bh1750 = nullptr; // Se vuelve a nullptr sino queda el valor anterior
+  }
+}
+
+/**
+ * @brief Registra el nuevo estado de un botón (ya sin rebotes)
+ *
+ * Si se presiona el primer boton y cualquier otro (al mismo tiempo),
+ * se restaura la tarea del seno en el rgb.
+ *
+ * @param i índice del botón en BTNS
+ * @param pressed si está presionado
+ * @param us micros() del cambio
+ */
+void setButtonState(size_t i, bool pressed, uint32_t us) {
+  if (last_btn_states[i] == pressed) return;
+  if (pressed && i > 0 && last_btn_states[0]) {
+    setRGBEffect(EFFECT_FADE);
+  }
+  last_btn_states[i] = pressed;
+  sendButtonEvent(i, pressed, us);
+}
+
+#ifndef BTN_POLLING
+/**
+ * @brief Interrupción por cambio de nivel de un botón
+ *
+ * Solo encola el flanco; si la cola está llena se cuenta en overflows() y
+ * serviceButtons() se resincroniza con el nivel de los pines.
+ *
+ * @param arg índice del botón en BTNS
+ */
+void IRAM_ATTR onButtonEdge(void *arg) {
+  uint8_t i{static_cast<uint8_t>(reinterpret_cast<uintptr_t>(arg))};
+  btn_edges.push(ButtonEdge{micros(), i, uint8_t(digitalRead(BTNS[i]))});
+}
+
+/**
+ * @brief Aplica el estado de un botón físico o virtual (web)
+ *
+ * @param i índice del botón en BTNS
+ * @param us micros() del cambio
+ */
+void applyButton(size_t i, uint32_t us) {
+  bool pressed{is_webbtn_pressed[i] || btn_debouncer.stable(i) == LOW};
+  setButtonState(i, pressed, us);
+}
+
+/**
+ * @brief Procesa los flancos encolados por onButtonEdge() (desde loop())
+ *
+ */
+void serviceButtons() {
+  if (btn_edges.overflows() != btn_overflows_seen) {
+    // Se perdieron flancos: un flanco con el nivel actual de cada pin
+    btn_overflows_seen = btn_edges.overflows();
+    for (size_t i{0}; i < LEN(BTNS); i++) {
+      btn_debouncer.edge(
+          ButtonEdge{micros(), uint8_t(i), uint8_t(digitalRead(BTNS[i]))});
     }
   }
+  ButtonEdge edge;
+  while (btn_edges.pop(edge)) btn_debouncer.edge(edge);
+  if (!btn_debouncer.settling()) return;
+  while (btn_debouncer.poll(micros(), edge)) applyButton(edge.button, edge.us);
 }
+#endif
 
 /**
  * @brief Algoritmo con antirebote que lee los botones
  *
  * Lee los botones declarados en BTNS. Solo deja cargado el valor
- * del pulsador en last_btn_states (state).
- *
- * Si se presiona el primer boton y cualquier otro (al mismo tiempo),
- * se restaura la tarea del seno en el rgb.
+ * del pulsador en last_btn_states (state). Se usa solo con -D BTN_POLLING,
+ * si no los botones se atienden por interrupción (serviceButtons()).
  *
  * @param id asignado por el PeriodicTaskManager, no se utiliza.
  */
@@ -279,142 +789,1472 @@ void readBtns(uint8_t id __unused) {
     reads_btn[i] |= readBtnFrom(BTNS[i]);
 
     if (reads_btn[i] == 0x00) {
-      if (last_btn_states[i] != true) {
-        if (i > 0 && last_btn_states[0]) {
-          pTasker.unpause("rgb");
-        }
-        last_btn_states[i] = true;
-      }
+      setButtonState(i, true, micros());
     } else if (reads_btn[i] == 0xFF) {
-      if (last_btn_states[i] != false) {
-        last_btn_states[i] = false;
-      }
+      setButtonState(i, false, micros());
     }
   }
 }
 
 /**
- * @brief Intercala los colores del LED RGB con los valores de un seno
+ * @brief Toma una foto del estado actual del hardware
+ *
+ * @param state donde se copia el estado
+ */
+void captureState(BoardState &state) {
+  // Los pasos de un efecto no cambian el estado, solo el efecto elegido
+  state.rgb = rgb_fx.animated() ? rgb_fx.color() : rgb_fx.output();
+  state.fx = rgb_fx.effect();
+  state.fx_period = rgb_fx.period();
+  for (size_t i{0}; i < LEN(BTNS); i++) {
+    state.btns[i] = last_btn_states[i];
+  }
+  state.ldr = lrd_value;
+  state.lcd_connected = i2c.connected(DEV_LCD);
+  for (size_t r{0}; r < 2; r++) {
+    memcpy(state.lcdrows[r], lcdrows[r], sizeof(state.lcdrows[r]));
+  }
+  state.aht_connected = i2c.connected(DEV_AHT10);
+  state.tmp = tmp;
+  state.hum = hum;
+  state.bh_connected = i2c.connected(DEV_BH1750);
+  state.lx = lx;
+}
+
+/**
+ * @brief Copia datos en un nuevo buffer del websocket y lo reserva
  *
- * Se utiliza una look up table (SINE_LUT) con medio seno para incrementar
- * y decrementar la intensidad del LED RGB.
+ * El buffer queda bloqueado (lock) hasta que se libere con releaseBuffer().
  *
- * @param id asignado por el PerdiodicTaskManager, no se utiliza.
+ * @return AsyncWebSocketMessageBuffer* el buffer o nullptr si no hay memoria
  */
-void rgbSine(uint8_t id __unused) {
-  static bool up_down = true;
-  static int color_value[LEN(RGB)]{0}, nv{0};
+AsyncWebSocketMessageBuffer *makeLockedBuffer(const void *data, size_t len) {
+  AsyncWebSocketMessageBuffer *buffer{ws.makeBuffer(len)};
+  if (buffer == nullptr) return nullptr;
+  memcpy(buffer->get(), data, len);
+  buffer->lock();
+  return buffer;
+}
 
-  color_value[nv] = up_down ? color_value[nv] + 1 : color_value[nv] - 1;
-  if (color_value[nv] >= 127) {
-    up_down = false;
-  } else if (color_value[nv] <= 0) {
-    up_down = true;
-    nv++;
-    nv %= 3;
-  }
-  for (size_t c{0}; c < LEN(RGB); c++) {
-    analogWrite(RGB[c], 255 - SINE_LUT[color_value[c]]);
+/**
+ * @brief Libera un buffer reservado con makeLockedBuffer()
+ *
+ * Se libera cuando lo terminen de enviar todos los clientes que lo usan.
+ */
+void releaseBuffer(AsyncWebSocketMessageBuffer *&buffer) {
+  if (buffer == nullptr) return;
+  buffer->unlock();
+  buffer = nullptr;
+  ws._cleanBuffers();
+}
+
+/**
+ * @brief Actualiza la foto compartida del estado
+ *
+ * Si el estado cambió se descartan los mensajes ya serializados y se
+ * incrementa la versión, sino no se hace nada.
+ */
+void refreshSnapshot() {
+  BoardState state{};
+  captureState(state);
+  if (snapshot.version != 0 && state == snapshot.state) return;
+  releaseBuffer(snapshot.json);
+  releaseBuffer(snapshot.binary);
+  snapshot.state = state;
+  snapshot.version++;
+}
+
+/**
+ * @brief Devuelve el estado actual completo listo para enviar
+ *
+ * Cada versión del estado se serializa una sola vez, sobre un buffer fijo, y
+ * se copia a un único AsyncWebSocketMessageBuffer que comparten todos los
+ * clientes que usan el mismo protocolo.
+ *
+ * @param binary true para el protocolo binario, false para JSON
+ * @return AsyncWebSocketMessageBuffer* buffer con el estado (nullptr si no hay
+ * memoria para el mensaje)
+ */
+AsyncWebSocketMessageBuffer *stateBuffer(bool binary) {
+  refreshSnapshot();
+  if (binary && snapshot.binary == nullptr) {
+    uint8_t frame[STATE_BIN_MAX];
+    size_t len{stateToBinary(snapshot.state, STATE_FIELD_ALL, frame,
+                             sizeof(frame))};
+    snapshot.binary = makeLockedBuffer(frame, len);
+  } else if (!binary && snapshot.json == nullptr) {
+    static char json[STATE_JSON_MAX];
+    size_t len{stateToJson(snapshot.state, json, sizeof(json))};
+    snapshot.json = makeLockedBuffer(json, len);
   }
-  rgb_value = "#";
-  for (size_t c{0}; c < LEN(RGB); c++) {
-    char tmp[3]{};
-    sprintf(tmp, "%02X", SINE_LUT[color_value[c]]);
-    rgb_value += tmp;
+  return binary ? snapshot.binary : snapshot.json;
+}
+
+/**
+ * @brief Envía el estado completo a un cliente en su protocolo
+ *
+ * @param client cliente destino
+ * @param binary true si el cliente usa el protocolo binario
+ */
+void sendState(AsyncWebSocketClient *client, bool binary) {
+  AsyncWebSocketMessageBuffer *hardware_state{stateBuffer(binary)};
+  if (hardware_state == nullptr) return;
+  countOut(current_command == CMD_INVALID ? uint8_t(OUT_STATE)
+                                          : uint8_t(current_command),
+           hardware_state->length());
+  if (binary) {
+    client->binary(hardware_state);
+  } else {
+    client->text(hardware_state);
   }
 }
 
+#ifdef BENCH_SNAPSHOT
 /**
- * @brief Envía al cliente la información del estado del hardware
+ * @brief Compara la serialización con String contra la de buffer fijo
  *
- * @param cmd el comando completo recibido por el cliente
- * @param client el cliente que envió la solicitud
+ * Se compila solo con -D BENCH_SNAPSHOT. Imprime por el puerto serie los µs
+ * por snapshot y los bytes de heap que quedan tomados mientras el mensaje
+ * está vivo (caída de ESP.getFreeHeap()), para cada implementación.
  */
-void getDataCommand(String &cmd, AsyncWebSocketClient *client) {
-  // verifico que el comando sea 'dat' y no 'data', u otra cosa inválida
-  if (cmd == "dat") {
-    String hardware_state{"{\"rgb\":\"" + rgb_value + "\""};
+void benchmarkSnapshot() {
+  const uint32_t RUNS{500};
+  BoardState state{};
+  captureState(state);
+
+  // Implementación anterior (String)
+  char rgb_value[8]{};
+  snprintf(rgb_value, sizeof(rgb_value), "#%06X", unsigned(state.rgb));
+  uint32_t heap_min{ESP.getFreeHeap()}, heap_before{heap_min};
+  uint32_t start{micros()};
+  for (uint32_t r{0}; r < RUNS; r++) {
+    String hardware_state{"{\"rgb\":\"" + String(rgb_value) + "\""};
     for (size_t i{0}; i < LEN(BTNS); i++) {
       hardware_state += ",\"btn" + String(i + 1) + "\":" + last_btn_states[i];
     }
     hardware_state += ",\"ldr\":" + String(lrd_value);
     hardware_state +=
-        ",\"lcd_connected\":" + String((is_lcd_connected) ? "true" : "false");
-    if (is_lcd_connected) {
-      hardware_state += ",\"lcd1row\":\"" + lcdrows[0] + "\"";
-      hardware_state += ",\"lcd2row\":\"" + lcdrows[1] + "\"";
+        ",\"lcd_connected\":" + String((i2c.connected(DEV_LCD)) ? "true" : "false");
+    if (i2c.connected(DEV_LCD)) {
+      hardware_state += ",\"lcd1row\":\"" + String(lcdrows[0]) + "\"";
+      hardware_state += ",\"lcd2row\":\"" + String(lcdrows[1]) + "\"";
     }
     hardware_state +=
-        ",\"aht_connected\":" + String((is_aht_connected) ? "true" : "false");
-    if (is_aht_connected) {
+        ",\"aht_connected\":" + String((i2c.connected(DEV_AHT10)) ? "true" : "false");
+    if (i2c.connected(DEV_AHT10)) {
       hardware_state += ",\"tmp\":" + String(tmp);
       hardware_state += ",\"hum\":" + String(hum);
     }
     hardware_state +=
-        ",\"bh_connected\":" + String((is_bh_connected) ? "true" : "false");
-    if (is_bh_connected) {
+        ",\"bh_connected\":" + String((i2c.connected(DEV_BH1750)) ? "true" : "false");
+    if (i2c.connected(DEV_BH1750)) {
       hardware_state += ",\"lx\":" + String(lx);
     }
     hardware_state += '}';
-    client->text(hardware_state);
-  } else {
-    client->text(BADREQ);
+    heap_min = min(heap_min, ESP.getFreeHeap());
+  }
+  uint32_t legacy_us{micros() - start};
+  uint32_t legacy_bytes{heap_before - heap_min};
+
+  // Buffer fijo
+  static char json[STATE_JSON_MAX];
+  heap_min = heap_before = ESP.getFreeHeap();
+  start = micros();
+  for (uint32_t r{0}; r < RUNS; r++) {
+    stateToJson(state, json, sizeof(json));
+    heap_min = min(heap_min, ESP.getFreeHeap());
   }
+  uint32_t fixed_us{micros() - start};
+  uint32_t fixed_bytes{heap_before - heap_min};
+
+  Serial.printf("bench snapshot string: %.2f us/snap, %u heap bytes\r\n",
+                float(legacy_us) / RUNS, legacy_bytes);
+  Serial.printf("bench snapshot fixed : %.2f us/snap, %u heap bytes\r\n",
+                float(fixed_us) / RUNS, fixed_bytes);
 }
+#endif
 
 /**
- * @brief Establece el estado del botón
+ * @brief Busca el lugar que ocupa un cliente en la tabla ws_clients
  *
- * @param cmd el comando completo recibido por el cliente
- * @param client el cliente que envió la solicitud
+ * @param id id del cliente (0 busca un lugar libre)
+ * @return WsClientSlot* el lugar en la tabla o nullptr si no está
  */
-void setBtnCommand(String &cmd, AsyncWebSocketClient *client) {
-  int btn{atoi(cmd.substring(3).c_str())};
-  btn--;
-  if (btn >= 0 && btn < static_cast<int>(LEN(BTNS))) {
-    is_webbtn_pressed[btn] = !last_btn_states[btn];
+WsClientSlot *findClientSlot(uint32_t id) {
+  for (auto &slot : ws_clients) {
+    if (slot.id == id) return &slot;
   }
+  return nullptr;
 }
 
 /**
- * @brief Establece el estado del LED RGB
+ * @brief Envía el estado a los clientes suscriptos cuando cambia
  *
- * @param cmd el comando completo recibido por el cliente
- * @param client el cliente que envió el mensaje
+ * Los cambios que ocurren dentro de la ventana PUSH_WINDOW_MS (el período
+ * de esta tarea) se agrupan en un único mensaje. Si no hubo cambios, cada
+ * PUSH_KEEPALIVE_MS se reenvía el estado igualmente.
+ *
+ * A un cliente con WS_CLIENT_QUEUE_SOFT mensajes encolados no se le agregan
+ * más: el estado queda pendiente y, cuando se desagota, recibe solo el
+ * último estado completo (los intermedios se cuentan en coalesced).
+ *
+ * @param id asignado por el PeriodicTaskManager, no se utiliza.
  */
-void setRGBCommand(String &cmd, AsyncWebSocketClient *client) {
-  // Deja de actualizarse el led rgb con el seno
-  pTasker.pause("rgb");
-  // En cmd debería haber un 'rgb=#RRGGBB' donde RR,GG,BB son los valores
-  // en hexadecimal del color.
-  rgb_value = cmd.substring(4, 11); // Se extrae el valor RRGGBB en hexa
-  analogWrite(RGB[0], 255 - strtol(cmd.substring(5, 7).c_str(), NULL, 16));
-  analogWrite(RGB[1], 255 - strtol(cmd.substring(7, 9).c_str(), NULL, 16));
-  analogWrite(RGB[2], 255 - strtol(cmd.substring(9, 11).c_str(), NULL, 16));
+void pushState(uint8_t id __unused) {
+  static BoardState last_state{};
+  static uint32_t last_version{0};
+  static uint32_t last_push_ms{0};
+
+  bool has_subscribers{false}, has_pending{false};
+  for (auto &slot : ws_clients) {
+    has_subscribers |= slot.id != 0 && slot.subscribed;
+    has_pending |= slot.id != 0 && slot.subscribed && slot.push.pending;
+  }
+  if (!has_subscribers) return;
+
+  refreshSnapshot();
+  uint32_t now{millis()};
+  bool keepalive{now - last_push_ms >= PUSH_KEEPALIVE_MS};
+  bool changed{snapshot.version != last_version};
+  if (!changed && !keepalive && !has_pending) return;
+
+  // A los clientes binarios solo se les envían los campos que cambiaron
+  uint8_t fields{keepalive ? uint8_t(STATE_FIELD_ALL)
+                           : stateDiff(last_state, snapshot.state)};
+  AsyncWebSocketMessageBuffer *delta{nullptr};
+  for (auto &slot : ws_clients) {
+    if (slot.id == 0 || !slot.subscribed) continue;
+    AsyncWebSocketClient *client{ws.client(slot.id)};
+    if (client == nullptr) continue; // se está cerrando
+    PushAction action{pushAction(slot.push, changed, keepalive,
+                                 clientHasRoom(slot, client, WS_CLIENT_QUEUE_SOFT),
+                                 slot.binary && fields != STATE_FIELD_ALL)};
+    if (action == PUSH_DELTA && delta == nullptr) {
+      uint8_t frame[STATE_BIN_MAX];
+      size_t len{stateToBinary(snapshot.state, fields, frame, sizeof(frame))};
+      delta = makeLockedBuffer(frame, len);
+      // Sin memoria se le retiene: recibe el estado completo más adelante
+      if (delta == nullptr) action = PUSH_HOLD;
+    }
+    switch (action) {
+    case PUSH_SKIP:
+      continue;
+    case PUSH_HOLD:
+      pushHold(slot.push, changed, now);
+      continue;
+    case PUSH_DELTA:
+      countOut(OUT_STATE, delta->length());
+      client->binary(delta);
+      break;
+    case PUSH_FULL:
+      sendState(client, slot.binary);
+      break;
+    }
+    pushSent(slot.push, now);
+  }
+  releaseBuffer(delta);
+  if (changed || keepalive) {
+    last_state = snapshot.state;
+    last_version = snapshot.version;
+    last_push_ms = now;
+  }
 }
 
 /**
- * @brief Escribe un texto que viene desde la página web
- *
- * El comando es lcd=?<texto> donde '?' es 0 ó 1 (fila 1 ó 2)
- * y <texto> es lo que se escribe en el display. Deben ser
- * 16 chars codificados en ASCII estándar.
+ * @brief Cuantiza un valor en centésimas para el historial
  *
- * @param cmd el comando completo recibido por el cliente
- * @param client el cliente que envió el mensaje
+ * @param value valor a cuantizar
+ * @param scale multiplicador (100 para centésimas)
+ * @return int16_t valor saturado a int16_t (sin usar HISTORY_NONE)
  */
-void setLCDCommand(String &cmd, AsyncWebSocketClient *client) {
-  String text = cmd.substring(4);
-  int row = text[0] - '0';
-  lcdrows[row] = text.substring(1);
-  if (is_lcd_connected) {
-    lcd->setCursor(0, row);
-    lcd->print(lcdrows[row]);
-  }
+int16_t quantizeSample(float value, float scale) {
+  float q{value * scale + (value < 0 ? -0.5f : 0.5f)};
+  if (q >= INT16_MAX) return INT16_MAX;
+  if (q <= HISTORY_NONE + 1) return HISTORY_NONE + 1;
+  return static_cast<int16_t>(q);
 }
 
 /**
- * @brief Atiende los eventos del websocket desde los clientes
+ * @brief Muestra actual de los sensores cuantizada (canales HISTORY_NAMES)
+ *
+ * @param values destino, HISTORY_NONE en los sensores desconectados
+ */
+void currentSample(int16_t values[HISTORY_CHANNELS]) {
+  bool aht{i2c.connected(DEV_AHT10)}, bh{i2c.connected(DEV_BH1750)};
+  values[0] = aht ? quantizeSample(tmp_raw, 100) : int16_t(HISTORY_NONE);
+  values[1] = aht ? quantizeSample(hum_raw, 100) : int16_t(HISTORY_NONE);
+  values[2] = bh ? quantizeSample(lx_raw, 1) : int16_t(HISTORY_NONE);
+  values[3] = static_cast<int16_t>(ldr.value());
+}
+
+/**
+ * @brief Agrega una muestra de los sensores al historial
+ *
+ * @param id asignado por el PeriodicTaskManager, no se utiliza.
+ */
+void sampleHistory(uint8_t id __unused) {
+  int16_t values[HISTORY_CHANNELS];
+  currentSample(values);
+  history.add(values, millis());
+}
+
+/**
+ * @brief Toma una muestra del heap (ver el comando mem) y calcula las
+ * vueltas de loop() por segundo
+ *
+ * @param id asignado por el PeriodicTaskManager, no se utiliza.
+ */
+void sampleHeap(uint8_t id __unused) {
+  static uint32_t last_ms{0}, last_iterations{0};
+  heap_monitor.add(ESP.getFreeHeap(), ESP.getMaxFreeBlockSize(),
+                   ESP.getHeapFragmentation());
+  uint32_t now{millis()};
+  if (now != last_ms) {
+    loop_rate = uint64_t(loop_iterations - last_iterations) * 1000 /
+                (now - last_ms);
+  }
+  last_ms = now;
+  last_iterations = loop_iterations;
+}
+
+/**
+ * @brief Nombre de un tipo de mensaje saliente (ver WsOutKind)
+ *
+ * @param kind Command o WsOutKind
+ * @return const char* el código del comando, state, event o error
+ */
+const char *outKindName(uint8_t kind) {
+  static const char *const EXTRA[]{"state", "event", "error"};
+  return kind < CMD_COUNT ? COMMAND_NAMES[kind] : EXTRA[kind - CMD_COUNT];
+}
+
+/**
+ * @brief Transacciones en el bus de las lecturas de un dispositivo (sin los
+ * sondeos)
+ *
+ * Del LCD se cuentan las escrituras de celdas y de posición del cursor.
+ */
+uint32_t i2cTransactions(uint8_t dev) {
+  switch (dev) {
+  case DEV_LCD: return lcd_fb.cells() + lcd_fb.moves();
+  case DEV_AHT10: return aht10.transactions();
+  case DEV_BH1750: return bh1750.transactions();
+  }
+  return 0;
+}
+
+/**
+ * @brief Lecturas fallidas de un dispositivo (el LCD no informa errores)
+ *
+ */
+uint32_t i2cErrors(uint8_t dev) {
+  switch (dev) {
+  case DEV_AHT10: return aht10.errors();
+  case DEV_BH1750: return bh1750.errors();
+  }
+  return 0;
+}
+
+// Métricas de GET /metrics, en el formato de texto de Prometheus
+const MetricFamily METRICS[]{
+    {"esp_uptime_seconds", "gauge", "Segundos desde el arranque.", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, millis() / 1000);
+     }},
+    {"esp_loop_iterations_total", "counter", "Vueltas de loop().", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, loop_iterations);
+     }},
+    {"esp_loop_rate_hz", "gauge", "Vueltas de loop() en el último segundo.",
+     nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, loop_rate);
+     }},
+    {"ptm_runs_total", "counter", "Ejecuciones de las tareas periódicas.",
+     nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, pTasker.runs());
+     }},
+    {"ptm_late_ms_total", "counter",
+     "Suma del retraso de las tareas respecto de su vencimiento (ms).",
+     nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, pTasker.lateTotalMs());
+     }},
+    {"ptm_late_max_ms", "gauge", "Mayor retraso de una tarea (ms).", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, pTasker.lateMaxMs());
+     }},
+    {"ptm_task_overruns_total", "counter",
+     "Veces que una tarea arrancó un período o más tarde.",
+     [] { return uint8_t(MAX_TASKS); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       if (pTasker.name(i) != nullptr) {
+         w.sample(name, "task", pTasker.name(i), pTasker.overruns(i));
+       }
+     }},
+    {"ws_clients", "gauge", "Clientes conectados al websocket.", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       uint8_t n{0};
+       for (auto &slot : ws_clients) n += slot.id != 0;
+       w.sample(name, n);
+     }},
+    {"ws_rejected_total", "counter",
+     "Conexiones cerradas por superar MAX_WS_CLIENTS.", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, ws_rejected);
+     }},
+    {"ws_badreq_total", "counter", "Mensajes que no eran un comando válido.",
+     nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, ws_badreq);
+     }},
+    {"ws_frames_in_total", "counter", "Mensajes recibidos por comando.",
+     [] { return uint8_t(CMD_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "cmd", COMMAND_NAMES[i], ws_in[i].frames);
+     }},
+    {"ws_bytes_in_total", "counter", "Bytes recibidos por comando.",
+     [] { return uint8_t(CMD_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "cmd", COMMAND_NAMES[i], ws_in[i].bytes);
+     }},
+    {"ws_frames_out_total", "counter",
+     "Mensajes enviados por comando (respuestas) o tipo.",
+     [] { return uint8_t(OUT_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "kind", outKindName(i), ws_out[i].frames);
+     }},
+    {"ws_bytes_out_total", "counter",
+     "Bytes enviados por comando (respuestas) o tipo.",
+     [] { return uint8_t(OUT_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "kind", outKindName(i), ws_out[i].bytes);
+     }},
+    {"i2c_probes_total", "counter", "Sondeos del bus por dispositivo.",
+     [] { return uint8_t(DEV_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "dev", I2C_DRIVERS[i].name, i2c.probes(i));
+     }},
+    {"i2c_transactions_total", "counter",
+     "Transacciones de lectura/escritura por dispositivo.",
+     [] { return uint8_t(DEV_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "dev", I2C_DRIVERS[i].name, i2cTransactions(i));
+     }},
+    {"i2c_errors_total", "counter", "Lecturas fallidas por dispositivo.",
+     [] { return uint8_t(DEV_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "dev", I2C_DRIVERS[i].name, i2cErrors(i));
+     }},
+    {"i2c_disconnects_total", "counter", "Desconexiones por dispositivo.",
+     [] { return uint8_t(DEV_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "dev", I2C_DRIVERS[i].name, i2c.disconnects(i));
+     }},
+    {"sensor_reports_total", "counter",
+     "Lecturas reportadas (fuera de la banda muerta o por intervalo máximo).",
+     [] { return uint8_t(SENSOR_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "sensor", SENSOR_NAMES[i], report_filters[i].reports());
+     }},
+    {"sensor_suppressed_total", "counter",
+     "Lecturas descartadas por la banda muerta.",
+     [] { return uint8_t(SENSOR_COUNT); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       w.sample(name, "sensor", SENSOR_NAMES[i], report_filters[i].suppressed());
+     }},
+    {"i2c_sample_period_ms", "gauge",
+     "Período de muestreo actual (adaptivo) de los sensores I2C.",
+     [] { return uint8_t(2); },
+     [](PromWriter &w, const char *name, uint8_t i) {
+       if (i == 0) {
+         w.sample(name, "dev", "aht", ahtPeriod());
+       } else {
+         w.sample(name, "dev", "bh", bhPeriod());
+       }
+     }},
+    {"esp_heap_free_bytes", "gauge", "Heap libre.", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, ESP.getFreeHeap());
+     }},
+    {"esp_heap_max_block_bytes", "gauge", "Bloque libre más grande.", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, ESP.getMaxFreeBlockSize());
+     }},
+    {"esp_heap_fragmentation_percent", "gauge", "Fragmentación del heap.",
+     nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, ESP.getHeapFragmentation());
+     }},
+    {"esp_heap_free_min_bytes", "gauge", "Menor heap libre desde el arranque.",
+     nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, heap_monitor.low().free);
+     }},
+    {"esp_heap_max_block_min_bytes", "gauge",
+     "Menor bloque libre más grande desde el arranque.", nullptr,
+     [](PromWriter &w, const char *name, uint8_t) {
+       w.sample(name, heap_monitor.low().max_block);
+     }},
+};
+
+/**
+ * @brief GET /metrics: métricas en el formato de texto de Prometheus
+ *
+ * Se escriben a medida que se envían (respuesta chunked), de a una muestra
+ * por vez, sin armar todo el texto en memoria.
+ *
+ * @param request pedido HTTP
+ */
+void handleMetrics(AsyncWebServerRequest *request) {
+  AsyncWebServerResponse *response{request->beginChunkedResponse(
+      "text/plain; version=0.0.4",
+      [cursor = MetricsCursor{}](uint8_t *buf, size_t max_len,
+                                 size_t index __unused) mutable -> size_t {
+        return writeMetrics(METRICS, LEN(METRICS), cursor,
+                            reinterpret_cast<char *>(buf), max_len);
+      })};
+  response->addHeader("Cache-Control", "no-store");
+  request->send(response);
+}
+
+#ifdef SENSOR_LOG
+/**
+ * @brief Agrega un registro al log persistente (se escribe en la flash
+ * recién cuando se juntan LOG_BATCH)
+ *
+ * @param id asignado por el PeriodicTaskManager, no se utiliza.
+ */
+void logSensors(uint8_t id __unused) {
+  int16_t values[LOG_CHANNELS];
+  currentSample(values);
+  sensor_log.add(values, millis());
+}
+
+/**
+ * @brief Agrega los encabezados X-Log-* de una respuesta de GET /log
+ *
+ * @param response respuesta
+ * @param first posición del registro más viejo que se conserva
+ * @param start posición desde la que empieza el contenido
+ * @param end posición a pedir la próxima vez
+ */
+void addLogHeaders(AsyncWebServerResponse *response, uint32_t first,
+                   uint32_t start, uint32_t end) {
+  response->addHeader("X-Log-First", String(first));
+  response->addHeader("X-Log-Offset", String(start));
+  response->addHeader("X-Log-Next", String(end));
+  response->addHeader("X-Log-Record-Size", String(uint32_t(sizeof(LogRecord))));
+  response->addHeader("Cache-Control", "no-store");
+}
+
+/**
+ * @brief GET /log: descarga el log en binario (registros LogRecord)
+ *
+ * Se lee directo de los segmentos a medida que se envía (respuesta chunked),
+ * sin cargar el log en memoria. Para sincronizar solo lo nuevo se pide desde
+ * una posición en bytes con ?offset=N o con "Range: bytes=N-". Se responde
+ * 200 con el contenido desde X-Log-Offset, que es más que N si los
+ * registros pedidos ya se borraron (no se responde 206: el contenido puede
+ * no empezar en N ni llegar hasta X-Log-Next); 204 si no hay registros
+ * nuevos y 416 si N está más allá del final del log (por ejemplo porque se
+ * borró el filesystem). X-Log-Next indica desde dónde pedir la próxima vez;
+ * si se recibe menos es porque se rotó un segmento durante la descarga y
+ * se puede reanudar desde lo recibido.
+ *
+ * @param request pedido HTTP
+ */
+void handleLogDownload(AsyncWebServerRequest *request) {
+  const uint32_t RECORD{sizeof(LogRecord)};
+  uint32_t first{sensor_log.first() * RECORD};
+  uint32_t end{sensor_log.flushed() * RECORD};
+  uint32_t start{first};
+  if (request->hasParam("offset")) {
+    start = strtoul(request->getParam("offset")->value().c_str(), nullptr, 10);
+  } else if (request->hasHeader("Range")) {
+    const String &value{request->getHeader("Range")->value()};
+    if (value.startsWith("bytes=") and value.endsWith("-")) {
+      start = strtoul(value.c_str() + 6, nullptr, 10);
+    }
+  }
+  start -= start % RECORD;
+  AsyncWebServerResponse *response;
+  if (start > end) {
+    response = request->beginResponse(416);
+    response->addHeader("Content-Range", "bytes */" + String(end));
+    addLogHeaders(response, first, end, end);
+    request->send(response);
+    return;
+  }
+  if (start < first) start = first;
+  if (start == end) {
+    response = request->beginResponse(204);
+    addLogHeaders(response, first, start, end);
+    request->send(response);
+    return;
+  }
+  response = request->beginChunkedResponse(
+      "application/octet-stream",
+      [start, end](uint8_t *buf, size_t max_len, size_t index) -> size_t {
+        // read() es por bytes: un registro puede quedar partido en dos chunks
+        size_t pos{start + index};
+        if (pos >= end) return 0;
+        size_t len{max_len};
+        if (len > end - pos) len = end - pos;
+        return sensor_log.read(pos, buf, len);
+      });
+  addLogHeaders(response, first, start, end);
+  request->send(response);
+}
+#endif
+
+/**
+ * @brief Envía el historial pedido con 'his' de a partes
+ *
+ * En cada ejecución se envían a lo sumo HISTORY_CHUNK puntos a cada cliente
+ * que pidió el historial y tiene lugar en su cola de salida, así un pedido
+ * nunca ocupa el loop() ni la memoria del websocket por mucho tiempo.
+ *
+ * @param id asignado por el PeriodicTaskManager, no se utiliza.
+ */
+void streamHistory(uint8_t id __unused) {
+  static char json[1024];
+  for (auto &slot : ws_clients) {
+    if (slot.id == 0 || slot.history_level < 0) continue;
+    AsyncWebSocketClient *client{ws.client(slot.id)};
+    if (client == nullptr) {
+      slot.history_level = -1;
+      continue;
+    }
+    if (!clientHasRoom(slot, client, WS_CLIENT_QUEUE_SOFT)) continue;
+    uint8_t level{static_cast<uint8_t>(slot.history_level)};
+    uint32_t seq{max(slot.history_seq, history.oldest(level))};
+    BufferWriter w{json, sizeof(json)};
+    uint16_t n{history.writeChunk(level, seq, HISTORY_CHUNK, HISTORY_NAMES, w)};
+    if (w.overflow()) {
+      slot.history_level = -1;
+      continue;
+    }
+    sendText(client, json, CMD_HIS);
+    slot.history_seq = seq + n;
+    if (slot.history_seq >= history.total(level)) slot.history_level = -1;
+  }
+}
+
+/**
+ * @brief Compara los argumentos de un comando con un texto
+ *
+ * @param args argumentos (no terminan en '\0')
+ * @param len largo de args
+ * @param expected texto esperado
+ * @return true si son iguales
+ */
+bool argsEqual(const char *args, size_t len, const char *expected) {
+  return strlen(expected) == len && !memcmp(args, expected, len);
+}
+
+/**
+ * @brief Envía al cliente la información del estado del hardware
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool getDataCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  // verifico que el comando sea 'dat' y no 'data', u otra cosa inválida
+  if (len != 0) return false;
+  WsClientSlot *slot{findClientSlot(client->id())};
+  sendState(client, slot != nullptr && slot->binary);
+  return true;
+}
+
+/**
+ * @brief Suscribe (sub) o desuscribe (uns) al cliente del envío del estado
+ *
+ * Al suscribirse se le envía el estado completo en la próxima ventana de
+ * pushState(), luego solo recibe el estado cuando algo cambia.
+ *
+ * @param subscribe true para 'sub', false para 'uns'
+ * @param len largo de los argumentos (no lleva)
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool setSubscription(bool subscribe, size_t len, AsyncWebSocketClient *client) {
+  WsClientSlot *slot{findClientSlot(client->id())};
+  if (slot == nullptr || len != 0) return false;
+  slot->subscribed = subscribe;
+  // El estado completo lo envía pushState() en la próxima ventana, con el
+  // mismo control de la cola que los demás (y sin responder desde un lote)
+  if (slot->subscribed) pushHold(slot->push, false, millis());
+  return true;
+}
+
+/**
+ * @brief Comando 'sub', ver setSubscription()
+ */
+bool subscribeCommand(const char *args __unused, size_t len,
+                      AsyncWebSocketClient *client) {
+  return setSubscription(true, len, client);
+}
+
+/**
+ * @brief Comando 'uns', ver setSubscription()
+ */
+bool unsubscribeCommand(const char *args __unused, size_t len,
+                        AsyncWebSocketClient *client) {
+  return setSubscription(false, len, client);
+}
+
+/**
+ * @brief Establece el estado del botón
+ *
+ * El comando es btn? donde '?' es el número de botón (1 ó 2).
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool setBtnCommand(const char *args, size_t len,
+                   AsyncWebSocketClient *client __unused) {
+  int btn{len == 1 ? args[0] - '1' : -1};
+  if (btn < 0 || btn >= static_cast<int>(LEN(BTNS))) return false;
+  is_webbtn_pressed[btn] = !last_btn_states[btn];
+#ifndef BTN_POLLING
+  // sin flancos en el pin no hay interrupción: se aplica en el momento
+  applyButton(btn, micros());
+#endif
+  return true;
+}
+
+/**
+ * @brief Convierte dos dígitos hexadecimales en un byte
+ *
+ * @param hex los dos dígitos
+ * @return int el valor (0-255) o -1 si no son dígitos hexadecimales
+ */
+int parseHexByte(const char *hex) {
+  int value{0};
+  for (size_t i{0}; i < 2; i++) {
+    char c{hex[i]};
+    value <<= 4;
+    if (c >= '0' && c <= '9') value |= c - '0';
+    else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+    else return -1;
+  }
+  return value;
+}
+
+/**
+ * @brief Establece el estado del LED RGB
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió el mensaje
+ * @return true si el comando es válido
+ */
+bool setRGBCommand(const char *args, size_t len,
+                   AsyncWebSocketClient *client __unused) {
+  // En args debería haber un '=#RRGGBB' donde RR,GG,BB son los valores
+  // en hexadecimal del color.
+  int color[LEN(RGB)]{-1, -1, -1};
+  if (len == 8 && args[0] == '=' && args[1] == '#') {
+    for (size_t c{0}; c < LEN(RGB); c++) {
+      color[c] = parseHexByte(args + 2 + 2 * c);
+    }
+  }
+  if (color[0] < 0 || color[1] < 0 || color[2] < 0) return false;
+  rgb_fx.setColor(packRgb(color[0], color[1], color[2]));
+  // El efecto de respiración sigue con el nuevo color, los demás se detienen
+  if (rgb_fx.effect() == EFFECT_BREATHE) {
+    renderRGB(0);
+  } else {
+    setRGBEffect(EFFECT_STATIC);
+  }
+  return true;
+}
+
+/**
+ * @brief Escribe un texto que viene desde la página web
+ *
+ * El comando es lcd=?<texto> donde '?' es 0 ó 1 (fila 1 ó 2)
+ * y <texto> es lo que se escribe en el display. Deben ser
+ * 16 chars codificados en ASCII estándar. Solo se actualiza el
+ * framebuffer, el display se dibuja desde renderLCD().
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió el mensaje
+ * @return true si el comando es válido
+ */
+bool setLCDCommand(const char *args, size_t len,
+                   AsyncWebSocketClient *client __unused) {
+  int row{len >= 2 && args[0] == '=' ? args[1] - '0' : -1};
+  if (row != 0 && row != 1) return false;
+  size_t text_len{min(len - 2, size_t(BOARD_LCD_COLS))};
+  memcpy(lcdrows[row], args + 2, text_len);
+  lcdrows[row][text_len] = '\0';
+  lcd_fb.setRow(row, lcdrows[row], text_len);
+  return true;
+}
+
+#ifdef PTM_PROFILING
+/**
+ * @brief Envía las estadísticas de ejecución de las tareas periódicas
+ *
+ * El comando es 'prf' para consultarlas y 'prf=reset' para reiniciarlas.
+ * Por cada tarea se envía: cantidad de ejecuciones, duración mínima, máxima
+ * y media (µs), retraso máximo y medio respecto de su vencimiento (ms) y
+ * cantidad de vencimientos perdidos (retraso >= un período).
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool profileCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  if (argsEqual(args, len, "=reset")) {
+    pTasker.resetStats();
+  } else if (len != 0) {
+    return false;
+  }
+  static char json[96 * MAX_TASKS];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"prf\":[");
+  bool first{true};
+  for (uint8_t i{0}; i < MAX_TASKS; i++) {
+    TaskStats st{};
+    if (!pTasker.stats(i, st)) continue;
+    if (!first) w.put(',');
+    first = false;
+    w.put("{\"name\":\"");
+    w.putEscaped(pTasker.name(i));
+    w.put("\",\"runs\":");
+    w.putUInt(st.runs);
+    w.put(",\"min_us\":");
+    w.putUInt(st.runs ? st.min_us : 0);
+    w.put(",\"max_us\":");
+    w.putUInt(st.max_us);
+    w.put(",\"mean_us\":");
+    w.putUInt(st.mean_us());
+    w.put(",\"late_max_ms\":");
+    w.putUInt(st.max_late_ms);
+    w.put(",\"late_mean_ms\":");
+    w.putUInt(st.mean_late_ms());
+    w.put(",\"missed\":");
+    w.putUInt(st.missed);
+    w.put(",\"overruns\":");
+    w.putUInt(pTasker.overruns(i));
+    w.put('}');
+  }
+  w.put("]}");
+  if (w.overflow()) return false;
+  replyText(client, json);
+  return true;
+}
+#endif
+
+/**
+ * @brief Envía el estado de la cola de comandos
+ *
+ * El comando es 'que', responde con los comandos en espera, la capacidad,
+ * el máximo en espera alcanzado, los rechazados por cola llena y los
+ * descartados porque el cliente se desconectó.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool queueCommand(const char *args __unused, size_t len,
+                  AsyncWebSocketClient *client) {
+  if (len != 0) return false;
+  char json[128];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"queue\":{\"len\":");
+  w.putUInt(command_queue.size());
+  w.put(",\"cap\":");
+  w.putUInt(command_queue.capacity());
+  w.put(",\"max\":");
+  w.putUInt(command_queue.highWater());
+  w.put(",\"overflows\":");
+  w.putUInt(command_queue.overflows());
+  w.put(",\"dropped\":");
+  w.putUInt(commands_dropped);
+  w.put("}}");
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Pide el historial de los sensores
+ *
+ * El comando es his=<nivel>, con nivel 0 (muestras crudas cada
+ * HISTORY_RAW_MS), 1 (1 s), 2 (1 min) o 3 (15 min). El historial se envía
+ * de a partes desde streamHistory(), del punto más viejo al más nuevo.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool historyCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  if (len != 2 || args[0] != '=' || args[1] < '0' ||
+      args[1] >= '0' + HISTORY_LEVELS) {
+    return false;
+  }
+  WsClientSlot *slot{findClientSlot(client->id())};
+  if (slot == nullptr) return false;
+  slot->history_level = args[1] - '0';
+  slot->history_seq = history.oldest(slot->history_level);
+  return true;
+}
+
+/**
+ * @brief Elige el efecto del LED RGB y su velocidad
+ *
+ * El comando es efx=<efecto>[,<ms>] con el efecto static, fade, breathe o
+ * wheel y la duración de un ciclo en ms (RGB_PERIOD_MIN_MS a
+ * RGB_PERIOD_MAX_MS). Se responde con el efecto vigente, el color base y el
+ * color que muestra el LED en este momento (solo se formatea acá, el estado
+ * no cambia con cada paso del efecto):
+ * {"efx":"fade","period":36000,"rgb":"#RRGGBB","out":"#RRGGBB"}; solo efx
+ * lo consulta.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool effectCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  if (len > 0) {
+    if (args[0] != '=') return false;
+    const char *comma{static_cast<const char *>(memchr(args, ',', len))};
+    size_t name_len{comma ? size_t(comma - args - 1) : len - 1};
+    RgbEffect effect{RgbEffects::lookup(args + 1, name_len)};
+    if (effect == EFFECT_COUNT) return false;
+    if (comma != nullptr) {
+      char digits[8]{};
+      size_t n{len - (comma + 1 - args)};
+      if (n == 0 || n >= sizeof(digits)) return false;
+      memcpy(digits, comma + 1, n);
+      char *end;
+      uint32_t period{static_cast<uint32_t>(strtoul(digits, &end, 10))};
+      if (*end != '\0' || !rgb_fx.setPeriod(period)) return false;
+    }
+    setRGBEffect(effect);
+  }
+  char json[80];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"efx\":\"");
+  w.put(EFFECT_NAMES[rgb_fx.effect()]);
+  w.put("\",\"period\":");
+  w.putUInt(rgb_fx.period());
+  w.put(",\"rgb\":\"#");
+  w.putHex(rgb_fx.color(), 6);
+  w.put("\",\"out\":\"#");
+  w.putHex(rgb_fx.output(), 6);
+  w.put("\"}");
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Consulta el LDR y elige su filtro
+ *
+ * El comando es adc[=<filtro>[,<parámetro>]] con el filtro none, iir (el
+ * parámetro es el corrimiento, alfa = 1/2^n) o median (el parámetro es la
+ * cantidad de valores, impar). Se responde con
+ * {"adc":{"raw":N,"value":N,"filtered":N.NN,"noise":N.NN,"filter":"iir",
+ * "param":2,"oversample":8}}, con raw la última muestra cruda y noise el
+ * desvío estándar dentro de cada bloque (en cuentas del ADC).
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool adcCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  if (len > 0) {
+    if (args[0] != '=') return false;
+    const char *comma{static_cast<const char *>(memchr(args, ',', len))};
+    size_t name_len{comma ? size_t(comma - args - 1) : len - 1};
+    AdcFilter filter{AdcPipeline::lookup(args + 1, name_len)};
+    int param{0};
+    if (comma != nullptr) {
+      size_t n{len - (comma + 1 - args)};
+      if (n != 1 || comma[1] < '0' || comma[1] > '9') return false;
+      param = comma[1] - '0';
+    }
+    if (filter == ADC_FILTER_COUNT || !ldr.configure(filter, param)) {
+      return false;
+    }
+  }
+  char json[160];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"adc\":{\"raw\":");
+  w.putUInt(ldr.raw());
+  w.put(",\"value\":");
+  w.putUInt(ldr.value());
+  w.put(",\"filtered\":");
+  w.putFixed2(ldr.filtered16() / 16.0f);
+  w.put(",\"noise\":");
+  w.putFixed2(ldr.noise16() / 16.0f);
+  w.put(",\"filter\":\"");
+  w.put(ADC_FILTER_NAMES[ldr.filter()]);
+  w.put("\",\"param\":");
+  w.putUInt(ldr.param());
+  w.put(",\"oversample\":");
+  w.putUInt(ldr.oversample());
+  w.put("}}");
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Aplica los períodos configurados a las tareas
+ *
+ * Las que se reprograman solas toman el valor nuevo en su próxima ejecución.
+ */
+void applyTaskPeriods() {
+  for (uint8_t i{0}; i < task_periods.size(); i++) {
+    const TaskPeriod &entry{task_periods.entry(i)};
+    if (!entry.self_timed) pTasker.changeTicks(entry.name, task_periods.get(i));
+  }
+}
+
+/**
+ * @brief Carga los períodos guardados en TASK_PERIODS_FILE
+ *
+ * @return uint8_t cantidad de períodos aplicados
+ */
+uint8_t loadTaskPeriods() {
+  if (!LittleFS.exists(TASK_PERIODS_FILE)) return 0;
+  File f{LittleFS.open(TASK_PERIODS_FILE, "r")};
+  if (!f) return 0;
+  char text[32 * TASK_PERIODS_MAX];
+  size_t len{f.read(reinterpret_cast<uint8_t *>(text), sizeof(text))};
+  f.close();
+  return task_periods.parse(text, len);
+}
+
+/**
+ * @brief Guarda los períodos que no están en su valor por defecto
+ *
+ * Se escribe un archivo temporal y se renombra, así un corte de energía no
+ * deja el archivo a medias. Si todos están por defecto se borra el archivo.
+ *
+ * @return false si no se pudo escribir
+ */
+bool saveTaskPeriods() {
+  char text[32 * TASK_PERIODS_MAX];
+  size_t len{task_periods.serialize(text, sizeof(text))};
+  if (len == 0) {
+    return !LittleFS.exists(TASK_PERIODS_FILE) ||
+           LittleFS.remove(TASK_PERIODS_FILE);
+  }
+  const char *tmp_path{TASK_PERIODS_FILE ".tmp"};
+  File f{LittleFS.open(tmp_path, "w")};
+  if (!f) return false;
+  size_t written{f.write(reinterpret_cast<const uint8_t *>(text), len)};
+  f.close();
+  if (written != len) {
+    LittleFS.remove(tmp_path);
+    return false;
+  }
+  LittleFS.remove(TASK_PERIODS_FILE);
+  return LittleFS.rename(tmp_path, TASK_PERIODS_FILE);
+}
+
+/**
+ * @brief Consulta o cambia los períodos de las tareas
+ *
+ * El comando es cfg para consultarlos, cfg=<tarea>,<ms> para cambiar uno
+ * (dentro de sus límites) y cfg=reset para volver a los valores por
+ * defecto. Los cambios se aplican enseguida y se guardan en la flash. Se
+ * responde con {"cfg":[{"task":"rgb","ms":20,"min":10,"max":1000,
+ * "default":20},...],"saved":bool}.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool configCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  bool saved{true};
+  if (len > 0) {
+    if (args[0] != '=') return false;
+    if (len == 6 && memcmp(args + 1, "reset", 5) == 0) {
+      task_periods.reset();
+    } else {
+      const char *comma{static_cast<const char *>(memchr(args, ',', len))};
+      if (comma == nullptr) return false;
+      int8_t i{task_periods.find(args + 1, comma - args - 1)};
+      const char *digits{comma + 1}, *end{args + len};
+      if (i == -1 || digits == end || end - digits > 7) return false;
+      uint32_t ms{0};
+      for (const char *c{digits}; c < end; c++) {
+        if (*c < '0' || *c > '9') return false;
+        ms = ms * 10 + (*c - '0');
+      }
+      if (!task_periods.set(i, ms)) return false;
+    }
+    applyTaskPeriods();
+    saved = saveTaskPeriods();
+  }
+  static char json[32 + 80 * TASK_PERIODS_MAX];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"cfg\":[");
+  for (uint8_t i{0}; i < task_periods.size(); i++) {
+    const TaskPeriod &entry{task_periods.entry(i)};
+    if (i > 0) w.put(',');
+    w.put("{\"task\":\"");
+    w.put(entry.name);
+    w.put("\",\"ms\":");
+    w.putUInt(task_periods.get(i));
+    w.put(",\"min\":");
+    w.putUInt(entry.min_ms);
+    w.put(",\"max\":");
+    w.putUInt(entry.max_ms);
+    w.put(",\"default\":");
+    w.putUInt(entry.default_ms);
+    w.put('}');
+  }
+  w.put("],\"saved\":");
+  w.putBool(saved);
+  w.put('}');
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Consulta o cambia cuándo se reporta cada sensor
+ *
+ * El comando es rep para consultar y rep=<sensor>,<banda>[%],<min_ms>,<max_ms>
+ * para cambiar la banda muerta (absoluta o en % del último valor reportado)
+ * y los intervalos mínimo y máximo entre reportes (max_ms 0 es sin reporte
+ * forzado). Se responde con {"rep":[{"sensor":"tmp","band":0.10,"pct":false,
+ * "min_ms":1000,"max_ms":60000,"value":23.45,"reports":N,"suppressed":N},
+ * ...],"aht_ms":N,"bh_ms":N}, con aht_ms y bh_ms el período de muestreo
+ * actual (adaptivo) de cada sensor.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool reportCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  if (len > 0) {
+    char text[40];
+    if (args[0] != '=' || len >= sizeof(text)) return false;
+    memcpy(text, args + 1, len - 1);
+    text[len - 1] = '\0';
+    char *field{strchr(text, ',')};
+    if (field == nullptr) return false;
+    *field++ = '\0';
+    uint8_t sensor{0};
+    while (sensor < SENSOR_COUNT && strcmp(text, SENSOR_NAMES[sensor]) != 0) {
+      sensor++;
+    }
+    if (sensor == SENSOR_COUNT) return false;
+    char *end;
+    ReportPolicy policy{};
+    policy.deadband = strtof(field, &end);
+    policy.percent = *end == '%';
+    if (end == field) return false;
+    if (policy.percent) end++;
+    if (*end != ',') return false;
+    field = end + 1;
+    policy.min_interval_ms = strtoul(field, &end, 10);
+    if (end == field || *end != ',') return false;
+    field = end + 1;
+    policy.max_interval_ms = strtoul(field, &end, 10);
+    if (end == field || *end != '\0') return false;
+    if (!report_filters[sensor].setPolicy(policy)) return false;
+  }
+  char json[64 + 160 * SENSOR_COUNT];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"rep\":[");
+  for (uint8_t i{0}; i < SENSOR_COUNT; i++) {
+    const ReportFilter &f{report_filters[i]};
+    if (i > 0) w.put(',');
+    w.put("{\"sensor\":\"");
+    w.put(SENSOR_NAMES[i]);
+    w.put("\",\"band\":");
+    w.putFixed2(f.policy().deadband);
+    w.put(",\"pct\":");
+    w.putBool(f.policy().percent);
+    w.put(",\"min_ms\":");
+    w.putUInt(f.policy().min_interval_ms);
+    w.put(",\"max_ms\":");
+    w.putUInt(f.policy().max_interval_ms);
+    w.put(",\"value\":");
+    w.putFixed2(f.reported());
+    w.put(",\"reports\":");
+    w.putUInt(f.reports());
+    w.put(",\"suppressed\":");
+    w.putUInt(f.suppressed());
+    w.put('}');
+  }
+  w.put("],\"aht_ms\":");
+  w.putUInt(ahtPeriod());
+  w.put(",\"bh_ms\":");
+  w.putUInt(bhPeriod());
+  w.put('}');
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Agrega un campo del historial del heap al JSON
+ *
+ * @param w destino
+ * @param name nombre del arreglo
+ * @param field el campo de HeapSample
+ */
+void putHeapHistory(BufferWriter &w, const char *name,
+                    uint32_t HeapSample::*field) {
+  w.put(",\"");
+  w.put(name);
+  w.put("\":[");
+  for (uint8_t i{0}; i < heap_monitor.historyLen(); i++) {
+    if (i > 0) w.put(',');
+    w.putUInt(heap_monitor.history(i).*field);
+  }
+  w.put(']');
+}
+
+/**
+ * @brief Informa el uso del heap
+ *
+ * El comando es mem, se responde con
+ * {"mem":{"free":N,"max_block":N,"frag":N,"low":{"free":N,"max_block":N,
+ * "frag":N},"lcd_inits":N,"uptime_s":N,"group_s":N,"free_hist":[...],
+ * "block_hist":[...],"frag_hist":[...]}}. free y max_block en bytes, frag
+ * en % y low con los peores valores desde el arranque; los historiales
+ * tienen el peor valor de cada grupo de group_s segundos, del más viejo al
+ * más nuevo.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool memoryCommand(const char *args __unused, size_t len,
+                   AsyncWebSocketClient *client) {
+  if (len != 0) return false;
+  static char json[256 + 18 * HEAP_HISTORY_LEN];
+  BufferWriter w{json, sizeof(json)};
+  const HeapSample &last{heap_monitor.last()}, &low{heap_monitor.low()};
+  w.put("{\"mem\":{\"free\":");
+  w.putUInt(last.free);
+  w.put(",\"max_block\":");
+  w.putUInt(last.max_block);
+  w.put(",\"frag\":");
+  w.putUInt(last.frag);
+  w.put(",\"low\":{\"free\":");
+  w.putUInt(low.free);
+  w.put(",\"max_block\":");
+  w.putUInt(low.max_block);
+  w.put(",\"frag\":");
+  w.putUInt(low.frag);
+  w.put("},\"lcd_inits\":");
+  w.putUInt(lcd.constructions());
+  w.put(",\"uptime_s\":");
+  w.putUInt(millis() / 1000);
+  w.put(",\"group_s\":");
+  w.putUInt(uint32_t(HEAP_GROUP) * HEAP_SAMPLE_MS / 1000);
+  putHeapHistory(w, "free_hist", &HeapSample::free);
+  putHeapHistory(w, "block_hist", &HeapSample::max_block);
+  w.put(",\"frag_hist\":[");
+  for (uint8_t i{0}; i < heap_monitor.historyLen(); i++) {
+    if (i > 0) w.put(',');
+    w.putUInt(heap_monitor.history(i).frag);
+  }
+  w.put("]}}");
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Informa el estado del envío a cada cliente
+ *
+ * El comando es cli, se responde con
+ * {"clients":[{"id":N,"bin":bool,"sub":bool,"queue":N,"max_queue":N,
+ * "pending":bool,"coalesced":N,"dropped":N,"max_lag_ms":N},...],
+ * "max":MAX_WS_CLIENTS,"rejected":N}
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió la solicitud
+ * @return true si el comando es válido
+ */
+bool clientsCommand(const char *args __unused, size_t len,
+                    AsyncWebSocketClient *client) {
+  if (len != 0) return false;
+  char json[128 + 160 * MAX_WS_CLIENTS];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"clients\":[");
+  bool first{true};
+  for (auto &slot : ws_clients) {
+    if (slot.id == 0) continue;
+    AsyncWebSocketClient *c{ws.client(slot.id)};
+    if (!first) w.put(',');
+    first = false;
+    w.put("{\"id\":");
+    w.putUInt(slot.id);
+    w.put(",\"bin\":");
+    w.putBool(slot.binary);
+    w.put(",\"sub\":");
+    w.putBool(slot.subscribed);
+    w.put(",\"queue\":");
+    w.putUInt(c != nullptr ? c->queueLen() : 0);
+    w.put(",\"max_queue\":");
+    w.putUInt(slot.max_queue);
+    w.put(",\"pending\":");
+    w.putBool(slot.push.pending);
+    w.put(",\"coalesced\":");
+    w.putUInt(slot.push.coalesced);
+    w.put(",\"dropped\":");
+    w.putUInt(slot.dropped);
+    w.put(",\"max_lag_ms\":");
+    w.putUInt(slot.push.max_lag_ms);
+    w.put('}');
+  }
+  w.put("],\"max\":");
+  w.putUInt(MAX_WS_CLIENTS);
+  w.put(",\"rejected\":");
+  w.putUInt(ws_rejected);
+  w.put('}');
+  replyText(client, json);
+  return true;
+}
+
+bool batchCommand(const char *args, size_t len, AsyncWebSocketClient *client);
+
+// Arreglo de punteros a función a cada comando válido (en el orden de
+// Command, ver lib/WsCommand), nullptr si el comando no está disponible
+bool (*const COMMANDS[CMD_COUNT])(const char *, size_t, AsyncWebSocketClient *){
+    getDataCommand,   setBtnCommand,      setRGBCommand,
+    setLCDCommand,    subscribeCommand,   unsubscribeCommand,
+#ifdef PTM_PROFILING
+    profileCommand,
+#else
+    nullptr,
+#endif
+    batchCommand,     queueCommand,       historyCommand,
+    effectCommand,    adcCommand,         clientsCommand,   memoryCommand,
+    configCommand,    reportCommand,
+};
+
+/**
+ * @brief Identifica y ejecuta un comando
+ *
+ * @param data mensaje completo (código + argumentos)
+ * @param len largo del mensaje
+ * @param client el cliente que envió el mensaje
+ * @param in_batch true si es parte de un lote (no se permiten lotes anidados)
+ * @return true si el comando era válido y se ejecutó
+ */
+bool executeCommand(const char *data, size_t len, AsyncWebSocketClient *client,
+                    bool in_batch) {
+  Command cmd{lookupCommand(reinterpret_cast<const uint8_t *>(data), len)};
+  if (cmd == CMD_INVALID || COMMANDS[cmd] == nullptr) return false;
+  // El lote se responde una sola vez: no se aceptan comandos que respondan
+  if (in_batch && commandReplies(cmd)) return false;
+  return COMMANDS[cmd](data + COMMAND_CODE_LEN, len - COMMAND_CODE_LEN, client);
+}
+
+/**
+ * @brief Ejecuta varios comandos recibidos en un único mensaje
+ *
+ * El comando es bat\n<cmd1>\n<cmd2>... Los comandos se aplican en orden y
+ * de una sola vez (el lote ocupa un único lugar en la cola de comandos), y
+ * se responde una única vez con la cantidad de comandos aplicados
+ * ({"ack":N}) y, si alguno falló, el error y la lista de los que fallaron
+ * (numerados desde 1, con "truncated":true si no entraron todos). Las
+ * consultas y los comandos que responden fallan dentro de un lote.
+ *
+ * @param args lo que sigue al código del comando
+ * @param len largo de args
+ * @param client el cliente que envió el mensaje
+ * @return true si el formato del lote es válido
+ */
+bool batchCommand(const char *args, size_t len, AsyncWebSocketClient *client) {
+  if (len == 0 || args[0] != BATCH_SEPARATOR) return false;
+  // Cada comando ocupa al menos 4 bytes del mensaje, la lista entra entera;
+  // igual se corta antes de un número que no entre completo
+  char reply[WS_MAX_MESSAGE];
+  BufferWriter failed{reply, sizeof(reply)};
+  const size_t NUMBER_MAX{12}; // ',' + 10 dígitos + '\0'
+  bool truncated{false};
+  uint32_t ack{0}, n{0};
+  const char *end{args + len};
+  const char *cmd{args + 1};
+  while (cmd <= end) {
+    const char *sep{static_cast<const char *>(
+        memchr(cmd, BATCH_SEPARATOR, end - cmd))};
+    if (sep == nullptr) sep = end;
+    if (sep == cmd) { // se ignoran las líneas vacías
+      cmd = sep + 1;
+      continue;
+    }
+    n++;
+    if (executeCommand(cmd, sep - cmd, client, true)) {
+      ack++;
+    } else if (failed.length() + NUMBER_MAX > sizeof(reply)) {
+      truncated = true;
+    } else {
+      failed.put(failed.length() ? "," : "");
+      failed.putUInt(n);
+    }
+    cmd = sep + 1;
+  }
+  char json[sizeof(reply) + 64];
+  BufferWriter w{json, sizeof(json)};
+  w.put("{\"ack\":");
+  w.putUInt(ack);
+  if (ack != n) {
+    w.put(",\"error\":\"No es un comando válido.\",\"failed\":[");
+    w.put(reply);
+    w.put(']');
+    if (truncated || failed.overflow()) w.put(",\"truncated\":true");
+  }
+  w.put('}');
+  replyText(client, json);
+  return true;
+}
+
+/**
+ * @brief Ejecuta los comandos encolados desde el websocket
+ *
+ * Se llama desde loop() y ejecuta a lo sumo CMD_DRAIN_MAX comandos por
+ * llamada, así una ráfaga de comandos no demora a las tareas periódicas.
+ */
+void runQueuedCommands() {
+  for (uint8_t n{0}; n < CMD_DRAIN_MAX; n++) {
+    QueuedCommand *queued{command_queue.front()};
+    if (queued == nullptr) break;
+    AsyncWebSocketClient *client{ws.client(queued->client_id)};
+    if (client == nullptr) {
+      commands_dropped++;
+    } else {
+      current_command = queued->cmd;
+      if (!COMMANDS[queued->cmd](queued->args, queued->len, client)) {
+        ws_badreq++;
+        sendText(client, BADREQ, OUT_ERROR);
+      }
+      current_command = CMD_INVALID;
+    }
+    command_queue.release();
+  }
+}
+
+/**
+ * @brief Atiende los eventos del websocket desde los clientes
  *
  * Aquí, por una cuestión de orden y mantener todo en un solo archivo,
  * se encuentran los comandos y el arreglo a funciones que se ejecutan
@@ -430,37 +2270,77 @@ void setLCDCommand(String &cmd, AsyncWebSocketClient *client) {
 void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                       AwsEventType type, void *arg, uint8_t *data, size_t len) {
 
-  // Comandos válidos y arreglo de punteros a función a cada uno de ellos
-  static const char *CMDS[]{"dat", "btn", "rgb", "lcd"};
-  static void (*command[])(String &, AsyncWebSocketClient *){
-      getDataCommand, setBtnCommand, setRGBCommand, setLCDCommand};
-  //---------------------------------------------------------------------
-
   if (type == WS_EVT_CONNECT) {
     Serial.println("Cliente conectado: " + client->id());
+    WsClientSlot *slot{findClientSlot(0)};
+    if (slot == nullptr) {
+      // No hay lugar: se cierra con 1013 (Try Again Later)
+      ws_rejected++;
+      client->close(1013, "Demasiados clientes");
+      return;
+    }
+    // El protocolo se elige al conectarse: /ws?proto=bin para el binario
+    AsyncWebServerRequest *request{static_cast<AsyncWebServerRequest *>(arg)};
+    slot->id = client->id();
+    slot->subscribed = false;
+    slot->binary = request != nullptr && request->hasParam("proto") &&
+                   request->getParam("proto")->value() == "bin";
+    slot->message.reset();
+    slot->history_level = -1;
+    slot->push = StateBacklog{};
+    slot->dropped = 0;
+    slot->max_queue = 0;
   } else if (type == WS_EVT_DISCONNECT) {
     Serial.println("Cliente desconectado: " + client->id());
-  } else if (type == WS_EVT_DATA) {
-    // Se almacena el dato en el string msj
-    String msj{};
-    for (size_t i{0}; i < len; i++) {
-      msj += char(data[i]);
+    WsClientSlot *slot{findClientSlot(client->id())};
+    if (slot != nullptr) {
+      slot->id = 0;
+      slot->subscribed = false;
     }
-    // Se chequea si es un comando válido (de 3 caracteres)
-    // si se detecta un código válido, se ejecuta a través
-    // del arreglo de funciones 'command'
-    bool is_valid_command{false};
-    for (size_t i{0}; i < LEN(CMDS); i++) {
-      if (msj.substring(0, 3) == CMDS[i]) {
-        command[i](msj, client);
-        is_valid_command = true;
+  } else if (type == WS_EVT_DATA) {
+    AwsFrameInfo *info{static_cast<AwsFrameInfo *>(arg)};
+    // Caso común: el mensaje entero llegó en un solo paquete, se usa tal cual
+    if (!(info->num == 0 && info->final && info->index == 0 &&
+          info->len == len)) {
+      WsClientSlot *slot{findClientSlot(client->id())};
+      if (slot == nullptr) return;
+      switch (slot->message.feed(info->num == 0, info->final, info->index,
+                                 info->len, data, len)) {
+      case MessageAssembler::INCOMPLETE:
+        return;
+      case MessageAssembler::TOO_LONG:
+        ws_badreq++;
+        sendText(client, BADREQ, OUT_ERROR);
+        return;
+      case MessageAssembler::COMPLETE:
+        data = const_cast<uint8_t *>(slot->message.data());
+        len = slot->message.length();
         break;
       }
+    }
+    // Se chequea si es un comando válido (código de 3 caracteres)
+    // si se detecta un código válido, se encola con el resto del mensaje
+    // para ejecutarlo desde loop() a través del arreglo COMMANDS
+    Command cmd{lookupCommand(data, len)};
+    if (cmd == CMD_INVALID || COMMANDS[cmd] == nullptr ||
+        len - COMMAND_CODE_LEN > sizeof(QueuedCommand::args)) {
       // si no fue un comando válido se envía un mensaje de error
-      if (!is_valid_command) {
-        client->text(BADREQ);
-      }
+      ws_badreq++;
+      sendText(client, BADREQ, OUT_ERROR);
+      return;
     }
+    ws_in[cmd].frames++;
+    ws_in[cmd].bytes += len;
+    QueuedCommand *queued{command_queue.reserve()};
+    if (queued == nullptr) {
+      sendText(client, BUSY, OUT_ERROR);
+      return;
+    }
+    queued->cmd = cmd;
+    queued->client_id = client->id();
+    queued->len = len - COMMAND_CODE_LEN;
+    memcpy(queued->args, data + COMMAND_CODE_LEN, queued->len);
+    command_queue.commit();
   }
 }
 
@@ -482,44 +2362,91 @@ void setup() {
     ESP.reset();
   }
   Serial.println("Sistema de archivos montado con éxito.");
+#ifdef SENSOR_LOG
+  if (!sensor_log.begin()) {
+    Serial.println("No se pudo abrir el log de los sensores...");
+  }
+#endif
 
   // Se inicializa el I2C
   Wire.begin();
-  // Para verificar dónde está el LCD (0x3F//0x27) e inicializarlo
-  initLCD(0);
-  // Se inicializa el aht10 (temperatura y humedad)
-  initAHT10(0);
-  // Se inicializa el bh1750 (luxómetro)
-  initBH1750(0);
+  // Registra las tareas de lectura y busca el LCD (0x3F//0x27) y los sensores
+  if (!i2c.begin()) {
+    Serial.println("No hay lugar para las tareas de lectura del I2C...");
+  }
   // Inicialización del WiFi, WebSocket y Servidor Web
   WiFi.softAP(SSID, PSWD);
   ws.onEvent(onWebSocketEvent);
   server.addHandler(&ws);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+#ifdef SENSOR_LOG
+  // antes que serveStatic para que no lo busque como archivo
+  server.on("/log", HTTP_GET, handleLogDownload);
+#endif
+  // La página web está embebida en la flash (ver embed_assets.py), del
+  // filesystem solo se sirve lo que no esté embebido
+  serveWebAssets(server, WEB_ASSETS, LEN(WEB_ASSETS));
   server.serveStatic("/", LittleFS, "/", "max-age=600")
       .setDefaultFile("index.html");
   server.begin();
 
   /* Tareas a ejecutar periódicamente */
-  // cada 1 segundo chequea si están los dispositivos en el I2C
-  pTasker.add(initLCD, "lcd-init", 1000);
-  pTasker.add(initAHT10, "aht-init", 1000);
-  pTasker.add(initBH1750, "bh-init", 1000);
+  // Si una tarea se atrasa (por ejemplo por un sondeo lento del I2C), las de
+  // alta frecuencia se realinean a su grilla (SKIP) en vez de ejecutarse
+  // seguidas para recuperar los períodos perdidos, y las lecturas y sondeos
+  // cuentan el período desde que terminaron (FROM_COMPLETION).
+  // chequea si se conectaron o desconectaron dispositivos en el I2C (el
+  // sondeo se espacia hasta I2C_PROBE_MAX_MS mientras no haya cambios)
+  pTasker.add(scanI2C, "i2c", I2C_PROBE_MIN_MS, OverrunPolicy::FROM_COMPLETION);
+#ifdef BTN_POLLING
   // lectura de los botones cada 4ms.
   // 8 lecturas seguidas de un mismo estado da por sentado el estado
   // en la variable last_btn_states (state)
-  pTasker.add(readBtns, "btns", 4);
-  // Muestra un seno en el led (SINE_LUT) para cada color del alternado
-  // los colores (primero el rojo, luego verde y luego azul en ciclo)
-  pTasker.add(rgbSine, "rgb", 50);
-  // Se lee el ADC cada 125 ms
-  pTasker.add(readLDR, "ldr", 125);
-  // Se lee temperatura y humedad cada 500 ms
-  pTasker.add(readAHT10, "aht", 500);
-  // Se lee el luxómetro cada 200 ms (una lectura en alta resolución tarda ~120ms)
-  pTasker.add(readBH1750, "bh", 200);
+  pTasker.add(readBtns, "btns", 4, OverrunPolicy::SKIP);
+#else
+  // Interrupción por cada flanco de los botones (antirrebote en loop())
+  for (size_t i{0}; i < LEN(BTNS); i++) {
+    btn_debouncer.reset(i, digitalRead(BTNS[i]));
+    applyButton(i, micros());
+    attachInterruptArg(digitalPinToInterrupt(BTNS[i]), onButtonEdge,
+                       reinterpret_cast<void *>(i), CHANGE);
+  }
+#endif
+  // Efecto del led RGB (al arrancar sube y baja el rojo, luego el verde y
+  // luego el azul en ciclo), ver el comando efx
+  rgb_task = pTasker.add(renderRGB, "rgb", RGB_FRAME_MS, OverrunPolicy::SKIP);
+  // Se muestrea el ADC cada LDR_SAMPLE_MS (un valor filtrado cada
+  // LDR_OVERSAMPLE muestras)
+  pTasker.add(readLDR, "ldr", LDR_SAMPLE_MS, OverrunPolicy::SKIP);
+  // Envía el estado a los clientes suscriptos cuando hay cambios
+  pTasker.add(pushState, "push", PUSH_WINDOW_MS, OverrunPolicy::SKIP);
+  // Historial de los sensores: muestreo y envío de a partes
+  pTasker.add(sampleHistory, "his", HISTORY_RAW_MS, OverrunPolicy::SKIP);
+  pTasker.add(streamHistory, "his-tx", HISTORY_TX_MS, OverrunPolicy::SKIP);
+  // Uso del heap (libre, bloque máximo y fragmentación), ver el comando mem
+  pTasker.add(sampleHeap, "heap", HEAP_SAMPLE_MS, OverrunPolicy::SKIP);
+#ifdef SENSOR_LOG
+  // Log persistente: una escritura en la flash cada LOG_BATCH registros
+  pTasker.add(logSensors, "log", LOG_SAMPLE_MS, OverrunPolicy::FROM_COMPLETION);
+#endif
+  // Los períodos de arriba son los por defecto, se aplican los guardados
+  // con el comando cfg
+  if (loadTaskPeriods() > 0) {
+    applyTaskPeriods();
+    Serial.println("Períodos de las tareas cargados de " TASK_PERIODS_FILE);
+  }
+
+#ifdef BENCH_SNAPSHOT
+  benchmarkSnapshot();
+#endif
 }
 
 void loop() {
+  loop_iterations++;
   ws.cleanupClients();
+#ifndef BTN_POLLING
+  serviceButtons();
+#endif
+  runQueuedCommands();
   pTasker.refresh();
 }
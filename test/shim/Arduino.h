@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file Arduino.h
+ * @brief Reemplazo mínimo de Arduino.h para compilar en la PC ([env:native])
+ * @version 0.1
+ *
+ * Solo tiene lo que usan las bibliotecas de lib/ (y String, para comparar
+ * con la serialización anterior en los benchmarks). El reloj (millis/micros)
+ * no avanza solo, se controla desde los tests con shim::setMicros() y
+ * shim::advanceMillis().
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __ARDUINO_SHIM_H__
+#define __ARDUINO_SHIM_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <WString.h>
+
+#define F(X) (X)
+#define IRAM_ATTR
+#define __unused __attribute__((unused))
+
+namespace shim {
+inline uint64_t now_us = 0;
+inline void setMicros(uint64_t us) { now_us = us; }
+inline void advanceMicros(uint64_t us) { now_us += us; }
+inline void advanceMillis(uint32_t ms) { now_us += uint64_t(ms) * 1000; }
+} // namespace shim
+
+inline uint32_t micros() { return static_cast<uint32_t>(shim::now_us); }
+inline uint32_t millis() { return static_cast<uint32_t>(shim::now_us / 1000); }
+inline void yield() {}
+
+/**
+ * @brief Puerto serie que escribe en stdout
+ *
+ */
+struct ShimSerial {
+  void begin(unsigned long) {}
+  template <typename T> void print(T value) { printValue(value); }
+  template <typename T> void println(T value) {
+    printValue(value);
+    fputs("\r\n", stdout);
+  }
+  void printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+  }
+
+private:
+  void printValue(const char *value) { fputs(value, stdout); }
+  void printValue(char value) { fputc(value, stdout); }
+  void printValue(long long value) { ::printf("%lld", value); }
+  void printValue(unsigned long long value) { ::printf("%llu", value); }
+  void printValue(int value) { printValue((long long)value); }
+  void printValue(long value) { printValue((long long)value); }
+  void printValue(unsigned value) { printValue((unsigned long long)value); }
+  void printValue(unsigned long value) { printValue((unsigned long long)value); }
+  void printValue(double value) { ::printf("%.2f", value); }
+};
+inline ShimSerial Serial;
+
+#endif // __ARDUINO_SHIM_H__
@@ -0,0 +1,142 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file FS.h
+ * @brief Reemplazo mínimo de FS.h para compilar en la PC ([env:native])
+ * @version 0.1
+ *
+ * Un filesystem en memoria: cada archivo es un vector de bytes por ruta y
+ * los directorios son solo nombres. Tiene lo que usan las bibliotecas de
+ * lib/ (open con "r", "r+", "w" y "a", openDir, remove, truncate...).
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __FS_SHIM_H__
+#define __FS_SHIM_H__
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fs {
+
+using Data = std::shared_ptr<std::vector<uint8_t>>;
+
+class File {
+private:
+  Data _data;
+  size_t _pos = 0;
+  bool _append = false;
+
+public:
+  operator bool() const { return _data != nullptr; }
+  size_t write(const uint8_t *buf, size_t len) {
+    if (_append) _pos = _data->size();
+    if (_data->size() < _pos + len) _data->resize(_pos + len);
+    memcpy(_data->data() + _pos, buf, len);
+    _pos += len;
+    return len;
+  }
+  size_t read(uint8_t *buf, size_t len) {
+    if (_pos >= _data->size()) return 0;
+    if (len > _data->size() - _pos) len = _data->size() - _pos;
+    memcpy(buf, _data->data() + _pos, len);
+    _pos += len;
+    return len;
+  }
+  bool seek(uint32_t pos) {
+    if (pos > _data->size()) return false;
+    _pos = pos;
+    return true;
+  }
+  size_t position() const { return _pos; }
+  size_t size() const { return _data->size(); }
+  bool truncate(uint32_t size) {
+    _data->resize(size);
+    if (_pos > size) _pos = size;
+    return true;
+  }
+  void close() { _data = nullptr; }
+
+  File() = default;
+  File(Data data, bool append) : _data{data}, _append{append} {}
+};
+
+class Dir {
+private:
+  std::vector<std::pair<std::string, size_t>> _entries;
+  size_t _next = 0;
+
+public:
+  bool next() { return _next++ < _entries.size(); }
+  std::string fileName() const { return _entries[_next - 1].first; }
+  size_t fileSize() const { return _entries[_next - 1].second; }
+
+  Dir(std::vector<std::pair<std::string, size_t>> entries)
+      : _entries{entries} {}
+};
+
+class FS {
+private:
+  std::map<std::string, Data> _files;
+  std::set<std::string> _dirs;
+
+public:
+  bool exists(const char *path) const {
+    return _files.count(path) or _dirs.count(path);
+  }
+  bool mkdir(const char *path) {
+    _dirs.insert(path);
+    return true;
+  }
+  bool remove(const char *path) { return _files.erase(path) > 0; }
+  File open(const char *path, const char *mode) {
+    auto it = _files.find(path);
+    if (mode[0] == 'r') {
+      return it == _files.end() ? File{} : File{it->second, false};
+    }
+    if (it == _files.end() or mode[0] == 'w') {
+      it = _files.insert_or_assign(path, std::make_shared<std::vector<uint8_t>>())
+               .first;
+    }
+    return File{it->second, mode[0] == 'a'};
+  }
+  Dir openDir(const char *path) const {
+    std::string prefix = std::string(path) + "/";
+    std::vector<std::pair<std::string, size_t>> entries;
+    for (const auto &file : _files) {
+      if (file.first.compare(0, prefix.size(), prefix) != 0) continue;
+      std::string name = file.first.substr(prefix.size());
+      if (name.find('/') == std::string::npos)
+        entries.push_back({name, file.second->size()});
+    }
+    return Dir{entries};
+  }
+  size_t files() const { return _files.size(); }
+};
+
+} // namespace fs
+
+using fs::File;
+
+#endif // __FS_SHIM_H__
@@ -0,0 +1,125 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file WString.h
+ * @brief Reemplazo mínimo de la clase String de Arduino ([env:native])
+ * @version 0.1
+ *
+ * Se comporta como la del core del ESP8266 en lo que importa para medir
+ * memoria: hasta 11 caracteres van dentro del objeto (SSO) y cada vez que
+ * el texto crece se pide un bloque del largo justo (con new, así lo cuentan
+ * los benchmarks) y se copia. String(float) usa dos decimales.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __WSTRING_SHIM_H__
+#define __WSTRING_SHIM_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+class String {
+private:
+  static const size_t SSO_CAP = 11;
+  char _sso[SSO_CAP + 1] = "";
+  char *_heap = nullptr;
+  size_t _len = 0;
+  size_t _cap = SSO_CAP;
+
+  char *buffer() { return _heap ? _heap : _sso; }
+  void reserve(size_t len) {
+    if (len <= _cap) return;
+    char *grown = new char[len + 1];
+    memcpy(grown, this->c_str(), _len + 1);
+    delete[] _heap;
+    _heap = grown;
+    _cap = len;
+  }
+
+public:
+  String(const char *str = "") { this->concat(str, strlen(str)); }
+  String(const String &other) { this->concat(other.c_str(), other._len); }
+  String(String &&other) : _heap{other._heap}, _len{other._len}, _cap{other._cap} {
+    memcpy(_sso, other._sso, sizeof(_sso));
+    other._heap = nullptr;
+    other._len = 0;
+    other._cap = SSO_CAP;
+    other._sso[0] = '\0';
+  }
+  String(char c) { this->concat(&c, 1); }
+  String(int value) { this->concatf("%d", value); }
+  String(unsigned value) { this->concatf("%u", value); }
+  String(long value) { this->concatf("%ld", value); }
+  String(unsigned long value) { this->concatf("%lu", value); }
+  String(float value) { this->concatf("%.2f", double(value)); }
+  String(double value) { this->concatf("%.2f", value); }
+  ~String() { delete[] _heap; }
+
+  String &operator=(const String &other) {
+    if (this != &other) {
+      _len = 0;
+      buffer()[0] = '\0';
+      this->concat(other.c_str(), other._len);
+    }
+    return *this;
+  }
+
+  void concat(const char *str, size_t n) {
+    this->reserve(_len + n);
+    memcpy(buffer() + _len, str, n);
+    _len += n;
+    buffer()[_len] = '\0';
+  }
+  template <typename T> void concatf(const char *fmt, T value) {
+    char digits[32];
+    this->concat(digits, snprintf(digits, sizeof(digits), fmt, value));
+  }
+
+  String &operator+=(const String &str) {
+    this->concat(str.c_str(), str._len);
+    return *this;
+  }
+  String &operator+=(const char *str) {
+    this->concat(str, strlen(str));
+    return *this;
+  }
+  String &operator+=(char c) {
+    this->concat(&c, 1);
+    return *this;
+  }
+  String &operator+=(bool value) {
+    this->concatf("%u", unsigned(value));
+    return *this;
+  }
+
+  const char *c_str() const { return _heap ? _heap : _sso; }
+  size_t length() const { return _len; }
+};
+
+inline String operator+(String lhs, const String &rhs) { return lhs += rhs; }
+inline String operator+(String lhs, const char *rhs) { return lhs += rhs; }
+inline String operator+(String lhs, char rhs) { return lhs += rhs; }
+inline String operator+(String lhs, bool rhs) { return lhs += rhs; }
+inline String operator+(const char *lhs, const String &rhs) {
+  return String(lhs) += rhs;
+}
+
+#endif // __WSTRING_SHIM_H__
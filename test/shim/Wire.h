@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+/**
+ * @file Wire.h
+ * @brief Reemplazo mínimo de Wire.h para compilar en la PC ([env:native])
+ * @version 0.1
+ *
+ * Un bus falso: guarda lo último que se escribió y responde a requestFrom()
+ * con los bytes cargados desde el test con respond(). Si present es false
+ * ningún dispositivo contesta, y nack[] desconecta direcciones puntuales.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef __WIRE_SHIM_H__
+#define __WIRE_SHIM_H__
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  bool present = true;
+  bool nack[128]{};
+  uint8_t address = 0;
+  uint8_t written[8]{};
+  uint8_t n_written = 0;
+  uint32_t transmissions = 0;
+
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t addr) {
+    address = addr;
+    n_written = 0;
+  }
+  size_t write(uint8_t value) {
+    if (n_written < sizeof(written)) written[n_written++] = value;
+    return 1;
+  }
+  uint8_t endTransmission(bool stop = true) {
+    transmissions++;
+    return present and not nack[address & 0x7F] ? 0 : 2;
+  }
+  void respond(const uint8_t *data, uint8_t len) {
+    memcpy(_rx, data, len);
+    _rx_len = len;
+  }
+  uint8_t requestFrom(uint8_t addr, uint8_t len) {
+    address = addr;
+    _rx_pos = 0;
+    return present and len <= _rx_len ? len : 0;
+  }
+  int available() { return _rx_len - _rx_pos; }
+  int read() { return _rx_pos < _rx_len ? _rx[_rx_pos++] : -1; }
+
+private:
+  uint8_t _rx[8]{};
+  uint8_t _rx_len = 0;
+  uint8_t _rx_pos = 0;
+};
+
+inline TwoWire Wire;
+
+#endif // __WIRE_SHIM_H__
@@ -0,0 +1,94 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del sobremuestreo y filtrado del ADC (pio test -e native)
+
+#include <AdcPipeline.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+static void feedBlock(AdcPipeline &adc, const uint16_t *samples, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    TEST_ASSERT_EQUAL_UINT8(i == n - 1, adc.add(samples[i]));
+  }
+}
+
+void test_decimation_and_noise() {
+  AdcPipeline adc{4, ADC_FILTER_NONE, 0};
+  const uint16_t flat[]{500, 500, 500, 500};
+  feedBlock(adc, flat, 4);
+  TEST_ASSERT_EQUAL_UINT16(500 * 16, adc.decimated16());
+  TEST_ASSERT_EQUAL_UINT16(500, adc.value());
+  TEST_ASSERT_EQUAL_UINT16(0, adc.noise16());
+  // media 501.5 (con fracción) y desvío 1.5 (24 / 16)
+  const uint16_t noisy[]{500, 503, 500, 503};
+  feedBlock(adc, noisy, 4);
+  TEST_ASSERT_EQUAL_UINT16(8024, adc.decimated16());
+  TEST_ASSERT_EQUAL_UINT16(503, adc.raw());
+  // el ruido se suaviza: 0 + (24 - 0) / 8
+  TEST_ASSERT_EQUAL_UINT16(3, adc.noise16());
+  TEST_ASSERT_EQUAL_UINT32(2, adc.blocks());
+}
+
+void test_iir_converges() {
+  AdcPipeline adc{1, ADC_FILTER_IIR, 2};
+  adc.add(0);
+  TEST_ASSERT_EQUAL_UINT16(0, adc.value());
+  adc.add(1000);
+  // un cuarto del escalón
+  TEST_ASSERT_EQUAL_UINT16(250, adc.value());
+  for (int i = 0; i < 60; i++) adc.add(1000);
+  TEST_ASSERT_EQUAL_UINT16(1000, adc.value());
+}
+
+void test_median_rejects_spikes() {
+  AdcPipeline adc{1, ADC_FILTER_MEDIAN, 3};
+  adc.add(100);
+  adc.add(100);
+  adc.add(1023); // pico aislado
+  TEST_ASSERT_EQUAL_UINT16(100, adc.value());
+  adc.add(100);
+  TEST_ASSERT_EQUAL_UINT16(100, adc.value());
+  adc.add(200);
+  adc.add(200);
+  TEST_ASSERT_EQUAL_UINT16(200, adc.value());
+}
+
+void test_configure() {
+  AdcPipeline adc{8, ADC_FILTER_IIR, 2};
+  TEST_ASSERT_FALSE(adc.configure(ADC_FILTER_IIR, 0));
+  TEST_ASSERT_FALSE(adc.configure(ADC_FILTER_IIR, ADC_IIR_SHIFT_MAX + 1));
+  TEST_ASSERT_FALSE(adc.configure(ADC_FILTER_MEDIAN, 4));
+  TEST_ASSERT_FALSE(adc.configure(ADC_FILTER_MEDIAN, ADC_MEDIAN_MAX + 2));
+  TEST_ASSERT_EQUAL_UINT8(ADC_FILTER_IIR, adc.filter());
+  TEST_ASSERT_TRUE(adc.configure(ADC_FILTER_MEDIAN, 5));
+  TEST_ASSERT_EQUAL_UINT8(5, adc.param());
+  TEST_ASSERT_EQUAL_UINT8(ADC_FILTER_MEDIAN, AdcPipeline::lookup("median", 6));
+  TEST_ASSERT_EQUAL_UINT8(ADC_FILTER_COUNT, AdcPipeline::lookup("iirx", 4));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_decimation_and_noise);
+  RUN_TEST(test_iir_converges);
+  RUN_TEST(test_median_rejects_spikes);
+  RUN_TEST(test_configure);
+  return UNITY_END();
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests de la búsqueda de los archivos embebidos y del ETag
+// (pio test -e native)
+
+#include <WebAssetIndex.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+static const uint8_t DATA[]{0x1f, 0x8b};
+static const WebAsset ASSETS[]{
+    {"/index.html", "text/html", "1a2b3c4d", DATA, sizeof(DATA)},
+    {"/app.js", "application/javascript", "deadbeef", DATA, sizeof(DATA)},
+};
+static const size_t N{sizeof(ASSETS) / sizeof(ASSETS[0])};
+
+void test_lookup() {
+  TEST_ASSERT_EQUAL_PTR(&ASSETS[0], findWebAsset(ASSETS, N, "/index.html"));
+  TEST_ASSERT_EQUAL_PTR(&ASSETS[1], findWebAsset(ASSETS, N, "/app.js"));
+  // "/" no es un archivo, su ruta la registra serveWebAssets()
+  TEST_ASSERT_NULL(findWebAsset(ASSETS, N, "/"));
+  TEST_ASSERT_NULL(findWebAsset(ASSETS, N, "/app.j"));
+  TEST_ASSERT_NULL(findWebAsset(ASSETS, N, "/app.js/"));
+  TEST_ASSERT_NULL(findWebAsset(ASSETS, N, ""));
+  TEST_ASSERT_NULL(findWebAsset(ASSETS + 1, N - 1, "/index.html"));
+}
+
+void test_etag_match() {
+  TEST_ASSERT_TRUE(etagMatches("\"1a2b3c4d\"", "1a2b3c4d"));
+  TEST_ASSERT_TRUE(etagMatches("W/\"1a2b3c4d\"", "1a2b3c4d"));
+  TEST_ASSERT_TRUE(etagMatches("\"00000000\", \"1a2b3c4d\"", "1a2b3c4d"));
+  TEST_ASSERT_TRUE(etagMatches("*", "1a2b3c4d"));
+  // otra versión del archivo: se envía completo (200)
+  TEST_ASSERT_FALSE(etagMatches("\"00000000\"", "1a2b3c4d"));
+  TEST_ASSERT_FALSE(etagMatches("", "1a2b3c4d"));
+  // tiene que ser el ETag entero, no un pedazo
+  TEST_ASSERT_FALSE(etagMatches("\"1a2b3c4d00\"", "1a2b3c4d"));
+  TEST_ASSERT_FALSE(etagMatches("\"1a2b\"", "1a2b3c4d"));
+  TEST_ASSERT_FALSE(etagMatches("1a2b3c4d", "1a2b3c4d"));
+  TEST_ASSERT_FALSE(etagMatches("\"1a2b3c4d", "1a2b3c4d"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_lookup);
+  RUN_TEST(test_etag_match);
+  return UNITY_END();
+}
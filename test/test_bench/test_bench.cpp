@@ -0,0 +1,167 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Microbenchmarks en la PC (pio test -e native -f test_bench -v)
+//
+// Cada resultado se imprime en una línea "BENCH {json}" para poder filtrarlo
+// y compararlo entre versiones, por ejemplo:
+//   pio test -e native -f test_bench -v | grep '^BENCH' | cut -c7-
+
+#include <Arduino.h>
+#include <BoardState.h>
+#include <PeriodicTaskManager.h>
+#include <WsCommand.h>
+#include <unity.h>
+
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+
+// Se cuentan las asignaciones de memoria dinámica durante cada benchmark
+static size_t alloc_bytes = 0;
+static size_t alloc_count = 0;
+
+void *operator new(size_t size) {
+  alloc_bytes += size;
+  alloc_count++;
+  void *p = malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static volatile uint32_t sink = 0;
+
+/**
+ * @brief Mide el tiempo (reloj real de la PC) de runs llamadas a fn
+ *
+ */
+template <typename Fn>
+static void bench(const char *name, const char *params, uint32_t runs, Fn fn) {
+  alloc_bytes = alloc_count = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < runs; i++) fn(i);
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  printf("BENCH {\"name\":\"%s\",%s\"runs\":%u,\"ns_per_op\":%.1f,"
+         "\"bytes_per_op\":%.1f,\"allocs_per_op\":%.3f}\n",
+         name, params, runs, ns / runs, double(alloc_bytes) / runs,
+         double(alloc_count) / runs);
+}
+
+static void noopTask(uint8_t id) { sink += id; }
+
+void setUp() { shim::setMicros(0); }
+
+void tearDown() {}
+
+void bench_refresh() {
+  static const uint8_t COUNTS[]{1, 8, 16, 32, MAX_TASKS};
+  for (uint8_t n : COUNTS) {
+    PeriodicTaskManager tasker;
+    for (uint8_t i = 0; i < n; i++) tasker.add(noopTask, "t", 4 + i % 7 * 10);
+    char params[32];
+    snprintf(params, sizeof(params), "\"tasks\":%u,", n);
+    // Un ms por cada refresh(), como en el loop() del ESP
+    bench("refresh", params, 100000, [&](uint32_t) {
+      shim::advanceMicros(1000);
+      tasker.refresh();
+    });
+  }
+}
+
+void bench_lookup_command() {
+  static const char *MSGS[]{"dat", "lcd=0Hola mundo     ", "rgb=#A0B0C0",
+                            "btn1", "xyz"};
+  bench("lookup_command", "", 1000000, [&](uint32_t i) {
+    const char *msg = MSGS[i % 5];
+    sink += lookupCommand((const uint8_t *)msg, strlen(msg));
+  });
+}
+
+/**
+ * @brief Serialización anterior del estado, concatenando String (la que se
+ * reemplazó por stateToJson()), para comparar antes y después
+ *
+ */
+static String legacyStateJson(const BoardState &state) {
+  char rgb_value[8]{};
+  snprintf(rgb_value, sizeof(rgb_value), "#%06X", unsigned(state.rgb));
+  String hardware_state{"{\"rgb\":\"" + String(rgb_value) + "\""};
+  for (uint8_t i = 0; i < BOARD_BTNS; i++) {
+    hardware_state += ",\"btn" + String(i + 1) + "\":" + state.btns[i];
+  }
+  hardware_state += ",\"ldr\":" + String(state.ldr);
+  hardware_state +=
+      ",\"lcd_connected\":" + String(state.lcd_connected ? "true" : "false");
+  if (state.lcd_connected) {
+    hardware_state += ",\"lcd1row\":\"" + String(state.lcdrows[0]) + "\"";
+    hardware_state += ",\"lcd2row\":\"" + String(state.lcdrows[1]) + "\"";
+  }
+  hardware_state +=
+      ",\"aht_connected\":" + String(state.aht_connected ? "true" : "false");
+  if (state.aht_connected) {
+    hardware_state += ",\"tmp\":" + String(state.tmp);
+    hardware_state += ",\"hum\":" + String(state.hum);
+  }
+  hardware_state +=
+      ",\"bh_connected\":" + String(state.bh_connected ? "true" : "false");
+  if (state.bh_connected) {
+    hardware_state += ",\"lx\":" + String(state.lx);
+  }
+  hardware_state += '}';
+  return hardware_state;
+}
+
+void bench_snapshot() {
+  BoardState state{};
+  state.rgb = 0x80FF00;
+  state.ldr = 512;
+  state.lcd_connected = state.aht_connected = state.bh_connected = true;
+  strcpy(state.lcdrows[0], "ESP8266 IO Board");
+  strcpy(state.lcdrows[1], "WebSocket");
+  state.tmp = 23.5f;
+  state.hum = 48.25f;
+  state.lx = 312.5f;
+  char json[STATE_JSON_MAX];
+  // Antes y después producen el mismo JSON
+  stateToJson(state, json, sizeof(json));
+  TEST_ASSERT_EQUAL_STRING(json, legacyStateJson(state).c_str());
+  bench("snapshot_string", "", 200000, [&](uint32_t i) {
+    state.ldr = i & 0x3FF;
+    sink += legacyStateJson(state).length();
+  });
+  bench("snapshot_json", "", 200000, [&](uint32_t i) {
+    state.ldr = i & 0x3FF;
+    sink += stateToJson(state, json, sizeof(json));
+  });
+  uint8_t frame[STATE_BIN_MAX];
+  bench("snapshot_binary", "", 200000, [&](uint32_t i) {
+    state.ldr = i & 0x3FF;
+    sink += stateToBinary(state, STATE_FIELD_ALL, frame, sizeof(frame));
+  });
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(bench_refresh);
+  RUN_TEST(bench_lookup_command);
+  RUN_TEST(bench_snapshot);
+  return UNITY_END();
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del antirrebote por flancos (pio test -e native)
+
+#include <ButtonEvents.h>
+#include <unity.h>
+
+#define WINDOW 5000
+
+void setUp() {}
+void tearDown() {}
+
+void test_clean_press() {
+  EdgeDebouncer d{2, WINDOW};
+  d.reset(0, 1);
+  d.reset(1, 1);
+  ButtonEdge change{};
+  d.edge(ButtonEdge{1000, 0, 0});
+  TEST_ASSERT_TRUE(d.settling());
+  TEST_ASSERT_FALSE(d.poll(5999, change));
+  TEST_ASSERT_TRUE(d.poll(6000, change));
+  TEST_ASSERT_EQUAL_UINT32(1000, change.us);
+  TEST_ASSERT_EQUAL_UINT8(0, change.button);
+  TEST_ASSERT_EQUAL_UINT8(0, change.level);
+  TEST_ASSERT_EQUAL_UINT8(0, d.stable(0));
+  TEST_ASSERT_EQUAL_UINT8(1, d.stable(1));
+  TEST_ASSERT_FALSE(d.settling());
+  TEST_ASSERT_FALSE(d.poll(100000, change));
+}
+
+void test_bounces_keep_first_timestamp() {
+  EdgeDebouncer d{1, WINDOW};
+  d.reset(0, 1);
+  ButtonEdge change{};
+  d.edge(ButtonEdge{1000, 0, 0});
+  d.edge(ButtonEdge{1200, 0, 1});
+  d.edge(ButtonEdge{1500, 0, 0});
+  // la ventana cuenta desde el último rebote
+  TEST_ASSERT_FALSE(d.poll(6400, change));
+  TEST_ASSERT_TRUE(d.poll(6500, change));
+  TEST_ASSERT_EQUAL_UINT32(1000, change.us);
+  TEST_ASSERT_EQUAL_UINT8(0, change.level);
+  TEST_ASSERT_EQUAL_UINT32(2, d.bounces());
+}
+
+void test_glitch_and_resync_do_not_change() {
+  EdgeDebouncer d{1, WINDOW};
+  d.reset(0, 1);
+  ButtonEdge change{};
+  // pico de ruido que vuelve al mismo nivel
+  d.edge(ButtonEdge{1000, 0, 0});
+  d.edge(ButtonEdge{1100, 0, 1});
+  TEST_ASSERT_FALSE(d.poll(10000, change));
+  TEST_ASSERT_FALSE(d.settling());
+  // flanco de resincronización con el mismo nivel
+  d.edge(ButtonEdge{20000, 0, 1});
+  TEST_ASSERT_FALSE(d.poll(30000, change));
+  TEST_ASSERT_EQUAL_UINT8(1, d.stable(0));
+}
+
+void test_micros_overflow() {
+  EdgeDebouncer d{1, WINDOW};
+  d.reset(0, 0);
+  ButtonEdge change{};
+  d.edge(ButtonEdge{0xFFFFF000u, 0, 1});
+  TEST_ASSERT_FALSE(d.poll(0x00000100u, change));
+  TEST_ASSERT_TRUE(d.poll(0x00000400u, change));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFF000u, change.us);
+  TEST_ASSERT_EQUAL_UINT8(1, change.level);
+}
+
+void test_ignores_unknown_buttons() {
+  EdgeDebouncer d{2, WINDOW};
+  ButtonEdge change{};
+  d.edge(ButtonEdge{1000, 5, 1});
+  TEST_ASSERT_FALSE(d.settling());
+  TEST_ASSERT_FALSE(d.poll(100000, change));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_clean_press);
+  RUN_TEST(test_bounces_keep_first_timestamp);
+  RUN_TEST(test_glitch_and_resync_do_not_change);
+  RUN_TEST(test_micros_overflow);
+  RUN_TEST(test_ignores_unknown_buttons);
+  return UNITY_END();
+}
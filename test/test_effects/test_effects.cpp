@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests de los efectos del LED RGB (pio test -e native)
+
+#include <RgbEffects.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_tables() {
+  // las tablas se calculan al compilar
+  static_assert(rgb_lut::SINE.v[0] == 128, "seno(0)");
+  static_assert(rgb_lut::SINE.v[64] == 255, "seno(PI/2)");
+  static_assert(rgb_lut::SINE.v[192] == 0, "seno(3PI/2)");
+  static_assert(rgb_lut::GAMMA.v[0] == 0 and rgb_lut::GAMMA.v[255] == 255,
+                "extremos de gamma");
+  // 255 * 0.5^2.2 = 55.4
+  TEST_ASSERT_EQUAL_UINT8(56, RgbEffects::gamma(128));
+  for (int i = 1; i < 256; i++) {
+    TEST_ASSERT_TRUE(rgb_lut::GAMMA.v[i] >= rgb_lut::GAMMA.v[i - 1]);
+  }
+}
+
+void test_fade_cycles_channels() {
+  RgbEffects fx{EFFECT_FADE, 0, 3000};
+  TEST_ASSERT_EQUAL_HEX32(0x000000, fx.update(0));
+  TEST_ASSERT_EQUAL_HEX32(0xFF0000, fx.update(500));  // pico del rojo
+  TEST_ASSERT_EQUAL_HEX32(0x00FF00, fx.update(1500)); // pico del verde
+  TEST_ASSERT_EQUAL_HEX32(0x0000FF, fx.update(2500)); // pico del azul
+}
+
+void test_speed_independent_of_rate() {
+  RgbEffects slow{EFFECT_WHEEL, 0, 2000}, fast{EFFECT_WHEEL, 0, 2000};
+  slow.update(0);
+  fast.update(0);
+  for (uint32_t t = 5; t <= 1000; t += 5) fast.update(t);
+  slow.update(1000);
+  TEST_ASSERT_EQUAL_HEX32(fast.output(), slow.output());
+  // medio ciclo del círculo cromático: entre verde y azul
+  TEST_ASSERT_EQUAL_HEX32(0x00817E, slow.output());
+}
+
+void test_breathe_and_static() {
+  RgbEffects fx{EFFECT_BREATHE, 0xFF8000, 1000};
+  TEST_ASSERT_EQUAL_HEX32(0x000000, fx.update(0));
+  TEST_ASSERT_EQUAL_HEX32(0xFF8000, fx.update(500));
+  TEST_ASSERT_TRUE(fx.animated());
+  fx.setEffect(EFFECT_STATIC);
+  TEST_ASSERT_FALSE(fx.animated());
+  fx.setColor(0x123456);
+  TEST_ASSERT_EQUAL_HEX32(0x123456, fx.update(777));
+}
+
+void test_period_and_lookup() {
+  RgbEffects fx{EFFECT_FADE, 0, 1000};
+  TEST_ASSERT_FALSE(fx.setPeriod(RGB_PERIOD_MIN_MS - 1));
+  TEST_ASSERT_FALSE(fx.setPeriod(RGB_PERIOD_MAX_MS + 1));
+  TEST_ASSERT_EQUAL_UINT32(1000, fx.period());
+  TEST_ASSERT_TRUE(fx.setPeriod(5000));
+  TEST_ASSERT_EQUAL_UINT8(EFFECT_WHEEL, RgbEffects::lookup("wheel", 5));
+  TEST_ASSERT_EQUAL_UINT8(EFFECT_COUNT, RgbEffects::lookup("whee", 4));
+  TEST_ASSERT_EQUAL_UINT8(EFFECT_COUNT, RgbEffects::lookup("wheels", 6));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_tables);
+  RUN_TEST(test_fade_cycles_channels);
+  RUN_TEST(test_speed_independent_of_rate);
+  RUN_TEST(test_breathe_and_static);
+  RUN_TEST(test_period_and_lookup);
+  return UNITY_END();
+}
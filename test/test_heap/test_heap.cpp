@@ -0,0 +1,73 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del HeapMonitor (pio test -e native)
+
+#include <HeapMonitor.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_last_and_low() {
+  HeapMonitor heap{4};
+  heap.add(30000, 20000, 10);
+  heap.add(28000, 22000, 5);
+  heap.add(31000, 18000, 25);
+  TEST_ASSERT_EQUAL_UINT32(31000, heap.last().free);
+  TEST_ASSERT_EQUAL_UINT8(25, heap.last().frag);
+  // cada campo es el peor visto
+  TEST_ASSERT_EQUAL_UINT32(28000, heap.low().free);
+  TEST_ASSERT_EQUAL_UINT32(18000, heap.low().max_block);
+  TEST_ASSERT_EQUAL_UINT8(25, heap.low().frag);
+  TEST_ASSERT_EQUAL_UINT32(3, heap.samples());
+  TEST_ASSERT_EQUAL_UINT8(0, heap.historyLen()); // el grupo no se cerró
+}
+
+void test_history_groups() {
+  HeapMonitor heap{2};
+  heap.add(1000, 900, 1);
+  heap.add(800, 700, 3);
+  heap.add(2000, 1900, 0);
+  heap.add(1500, 1400, 2);
+  TEST_ASSERT_EQUAL_UINT8(2, heap.historyLen());
+  TEST_ASSERT_EQUAL_UINT32(800, heap.history(0).free);
+  TEST_ASSERT_EQUAL_UINT32(700, heap.history(0).max_block);
+  TEST_ASSERT_EQUAL_UINT8(3, heap.history(0).frag);
+  // el segundo grupo no arrastra los valores del primero
+  TEST_ASSERT_EQUAL_UINT32(1500, heap.history(1).free);
+  TEST_ASSERT_EQUAL_UINT8(2, heap.history(1).frag);
+}
+
+void test_history_wraps() {
+  HeapMonitor heap{1};
+  for (uint32_t i = 0; i < HEAP_HISTORY_LEN + 5; i++) heap.add(i, i, 0);
+  TEST_ASSERT_EQUAL_UINT8(HEAP_HISTORY_LEN, heap.historyLen());
+  // se descartaron los 5 más viejos
+  TEST_ASSERT_EQUAL_UINT32(5, heap.history(0).free);
+  TEST_ASSERT_EQUAL_UINT32(HEAP_HISTORY_LEN + 4, heap.history(HEAP_HISTORY_LEN - 1).free);
+  TEST_ASSERT_EQUAL_UINT32(0, heap.low().free);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_last_and_low);
+  RUN_TEST(test_history_groups);
+  RUN_TEST(test_history_wraps);
+  return UNITY_END();
+}
@@ -0,0 +1,94 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests del SensorHistory (pio test -e native)
+
+#include <Arduino.h>
+#include <SensorHistory.h>
+#include <unity.h>
+
+static const char *const NAMES[HISTORY_CHANNELS]{"a", "b", "c", "d"};
+
+static void addSample(SensorHistory &h, int16_t v, uint32_t now_ms) {
+  int16_t values[HISTORY_CHANNELS]{v, int16_t(-v), HISTORY_NONE, 7};
+  h.add(values, now_ms);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_buckets() {
+  static SensorHistory h{250};
+  // 4 muestras por segundo: 0, 10, 20, 30 | 40, 50, 60, 70 | 80
+  for (uint32_t i = 0; i < 9; i++) addSample(h, 10 * i, 250 * i);
+  TEST_ASSERT_EQUAL_UINT32(9, h.total(0));
+  TEST_ASSERT_EQUAL_UINT32(2, h.total(1));
+  TEST_ASSERT_EQUAL_UINT32(0, h.total(2));
+
+  HistoryPoint p;
+  TEST_ASSERT_TRUE(h.at(1, 1, p));
+  TEST_ASSERT_EQUAL_INT16(40, p.min[0]);
+  TEST_ASSERT_EQUAL_INT16(70, p.max[0]);
+  TEST_ASSERT_EQUAL_INT16(55, p.mean[0]);
+  TEST_ASSERT_EQUAL_INT16(-55, p.mean[1]);
+  TEST_ASSERT_EQUAL_INT16(HISTORY_NONE, p.mean[2]);
+  TEST_ASSERT_EQUAL_INT16(7, p.mean[3]);
+  TEST_ASSERT_FALSE(h.at(1, 2, p));
+
+  // 3 segundos sin muestras: quedan 3 buckets vacíos en el medio
+  addSample(h, 0, 6000);
+  TEST_ASSERT_EQUAL_UINT32(6, h.total(1));
+  TEST_ASSERT_TRUE(h.at(1, 2, p));
+  TEST_ASSERT_EQUAL_INT16(80, p.mean[0]);
+  TEST_ASSERT_TRUE(h.at(1, 4, p));
+  TEST_ASSERT_EQUAL_INT16(HISTORY_NONE, p.mean[0]);
+}
+
+void test_ring_wraps() {
+  static SensorHistory h{250};
+  for (uint32_t i = 0; i < HISTORY_RAW_LEN + 10; i++) addSample(h, i, 250 * i);
+  TEST_ASSERT_EQUAL_UINT32(10, h.oldest(0));
+  HistoryPoint p;
+  TEST_ASSERT_FALSE(h.at(0, 9, p));
+  TEST_ASSERT_TRUE(h.at(0, 10, p));
+  TEST_ASSERT_EQUAL_INT16(10, p.mean[0]);
+  TEST_ASSERT_TRUE(SensorHistory::bytes() < 8192);
+}
+
+void test_chunk_json() {
+  static SensorHistory h{250};
+  addSample(h, 2500, 0);
+  addSample(h, 2510, 250);
+  addSample(h, 2490, 500);
+  char json[512];
+  BufferWriter w{json, sizeof(json)};
+  TEST_ASSERT_EQUAL_UINT16(2, h.writeChunk(0, 1, 8, NAMES, w));
+  TEST_ASSERT_EQUAL_STRING("{\"his\":0,\"period\":250,\"seq\":1,\"n\":2,\"end\":true,"
+                           "\"a\":[2510,-20],\"b\":[-2510,20],\"c\":[null,null],"
+                           "\"d\":[7,0]}",
+                           json);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_buckets);
+  RUN_TEST(test_ring_wraps);
+  RUN_TEST(test_chunk_json);
+  return UNITY_END();
+}
@@ -0,0 +1,127 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests del I2CBusManager (pio test -e native)
+
+#include <Arduino.h>
+#include <I2CBusManager.h>
+#include <Wire.h>
+#include <unity.h>
+
+static uint32_t inits, teardowns, reads;
+static bool initDev(uint8_t) { return ++inits; }
+static void teardownDev() { teardowns++; }
+static void readDev(uint8_t) { reads++; }
+
+static const uint8_t SENSOR_ADDRS[]{0x10, 0x11};
+static const uint8_t DISPLAY_ADDRS[]{0x20};
+static const I2CDriver DRIVERS[]{
+    {"sensor", SENSOR_ADDRS, 2, initDev, teardownDev, readDev, 100,
+     OverrunPolicy::FROM_COMPLETION},
+    {"display", DISPLAY_ADDRS, 1, initDev, teardownDev, nullptr, 0,
+     OverrunPolicy::CATCH_UP},
+};
+
+void setUp() {
+  inits = teardowns = reads = 0;
+  shim::setMicros(0);
+  Wire = TwoWire{};
+}
+
+void tearDown() {}
+
+// Avanza el reloj de a 1ms llamando a refresh() cada I2C_PROBE_MIN_MS
+static void runFor(PeriodicTaskManager &tasker, I2CBusManager &bus, uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t++) {
+    shim::advanceMillis(1);
+    if (millis() % I2C_PROBE_MIN_MS == 0) bus.refresh();
+    tasker.refresh();
+  }
+}
+
+void test_connect_and_backoff() {
+  PeriodicTaskManager tasker;
+  I2CBusManager bus{tasker, DRIVERS, 2};
+  TEST_ASSERT_TRUE(bus.begin());
+  TEST_ASSERT_EQUAL_UINT32(2, inits);
+  TEST_ASSERT_EQUAL_HEX8(0x10, bus.address(0));
+  TEST_ASSERT_TRUE(bus.connected(1));
+  TEST_ASSERT_EQUAL_UINT32(I2C_PROBE_MIN_MS, bus.interval());
+
+  // Con la topología estable los sondeos se espacian hasta el máximo
+  uint32_t probes = bus.probes();
+  runFor(tasker, bus, 60000);
+  TEST_ASSERT_EQUAL_UINT32(I2C_PROBE_MAX_MS, bus.interval());
+  // 250+500+...+8000 = 15750ms, luego uno cada 8000ms: 2 sondeos por vez
+  TEST_ASSERT_EQUAL_UINT32(2 * (6 + (60000 - 15750) / 8000), bus.probes() - probes);
+  TEST_ASSERT_EQUAL_UINT32(600, reads);
+  TEST_ASSERT_EQUAL_UINT32(2, inits);
+}
+
+void test_disconnect_resets_backoff() {
+  PeriodicTaskManager tasker;
+  I2CBusManager bus{tasker, DRIVERS, 2};
+  bus.begin();
+  runFor(tasker, bus, 20000);
+  TEST_ASSERT_EQUAL_UINT32(I2C_PROBE_MAX_MS, bus.interval());
+
+  // Se desconecta el sensor: en el próximo sondeo se libera y se pausa su
+  // lectura, y se vuelve a sondear rápido
+  Wire.nack[0x10] = true;
+  Wire.nack[0x11] = true;
+  runFor(tasker, bus, I2C_PROBE_MAX_MS);
+  TEST_ASSERT_FALSE(bus.connected(0));
+  TEST_ASSERT_EQUAL_UINT32(1, teardowns);
+  TEST_ASSERT_TRUE(bus.interval() < I2C_PROBE_MAX_MS);
+  uint32_t r = reads;
+  runFor(tasker, bus, 1000);
+  TEST_ASSERT_EQUAL_UINT32(r, reads);
+
+  // Vuelve en la otra dirección posible y se detecta en el próximo sondeo
+  Wire.nack[0x11] = false;
+  runFor(tasker, bus, bus.interval() + I2C_PROBE_MIN_MS);
+  TEST_ASSERT_EQUAL_HEX8(0x11, bus.address(0));
+  TEST_ASSERT_EQUAL_UINT32(3, inits);
+  TEST_ASSERT_EQUAL_UINT32(1, bus.disconnects(0));
+  TEST_ASSERT_EQUAL_UINT32(0, bus.disconnects(1));
+  TEST_ASSERT_EQUAL_UINT32(bus.probes(), bus.probes(0) + bus.probes(1));
+  runFor(tasker, bus, 1000);
+  TEST_ASSERT_TRUE(reads > r);
+}
+
+void test_lost_and_reprobe() {
+  PeriodicTaskManager tasker;
+  I2CBusManager bus{tasker, DRIVERS, 2};
+  bus.begin();
+  runFor(tasker, bus, 20000);
+  bus.lost(1);
+  TEST_ASSERT_FALSE(bus.connected(1));
+  TEST_ASSERT_EQUAL_UINT32(I2C_PROBE_MIN_MS, bus.interval());
+  // el dispositivo sigue respondiendo: se reconecta en el próximo refresh
+  bus.refresh();
+  TEST_ASSERT_TRUE(bus.connected(1));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_connect_and_backoff);
+  RUN_TEST(test_disconnect_resets_backoff);
+  RUN_TEST(test_lost_and_reprobe);
+  return UNITY_END();
+}
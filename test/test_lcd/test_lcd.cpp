@@ -0,0 +1,154 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests del LcdFramebuffer (pio test -e native)
+
+#include <Arduino.h>
+#include <LcdFramebuffer.h>
+#include <unity.h>
+
+// Display falso: simula la DDRAM y cuenta las escrituras y los movimientos
+struct FakeDisplay {
+  char cells[LCD_FB_ROWS][LCD_FB_COLS];
+  uint8_t row = 0, col = 0;
+  uint32_t writes = 0, moves = 0;
+  bool unplugged = false; // las escrituras fallan
+  FakeDisplay() { memset(cells, ' ', sizeof(cells)); }
+  void setCursor(uint8_t c, uint8_t r) {
+    col = c;
+    row = r;
+    moves++;
+  }
+  size_t write(uint8_t ch) {
+    if (unplugged) return 0;
+    if (col < LCD_FB_COLS) cells[row][col] = ch;
+    col++;
+    writes++;
+    return 1;
+  }
+  bool shows(uint8_t r, const char *text) {
+    char row_text[LCD_FB_COLS + 1];
+    memset(row_text, ' ', LCD_FB_COLS);
+    memcpy(row_text, text, strlen(text));
+    return memcmp(cells[r], row_text, LCD_FB_COLS) == 0;
+  }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_diff_only() {
+  LcdFramebuffer fb;
+  FakeDisplay lcd;
+  fb.setRow(0, "Hola", 4);
+  // recién inicializado: el cursor está al principio, no hace falta moverlo
+  TEST_ASSERT_EQUAL_UINT8(4, fb.render(lcd, 32));
+  TEST_ASSERT_EQUAL_UINT32(0, lcd.moves);
+  TEST_ASSERT_TRUE(lcd.shows(0, "Hola"));
+  TEST_ASSERT_FALSE(fb.dirty());
+  TEST_ASSERT_EQUAL_UINT8(0, fb.render(lcd, 32));
+
+  // una sola celda distinta: un movimiento y una escritura
+  fb.setRow(0, "Hora", 4);
+  TEST_ASSERT_EQUAL_UINT8(1, fb.render(lcd, 32));
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.moves);
+  TEST_ASSERT_TRUE(lcd.shows(0, "Hora"));
+
+  // texto más corto: se borran las celdas que sobran
+  fb.setRow(0, "Ho", 2);
+  TEST_ASSERT_EQUAL_UINT8(2, fb.render(lcd, 32));
+  TEST_ASSERT_TRUE(lcd.shows(0, "Ho"));
+}
+
+void test_cursor_moves() {
+  LcdFramebuffer fb;
+  FakeDisplay lcd;
+  fb.setRow(0, "abcdef", 6);
+  fb.render(lcd, 32);
+  lcd.moves = lcd.writes = 0;
+  // entre dos celdas distintas hay una igual: se reescribe en vez de mover
+  fb.setRow(0, "XbXdef", 6);
+  TEST_ASSERT_EQUAL_UINT8(3, fb.render(lcd, 32));
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.moves);
+  TEST_ASSERT_TRUE(lcd.shows(0, "XbXdef"));
+  // cambio de fila: siempre se mueve el cursor
+  lcd.moves = 0;
+  fb.setRow(1, "z", 1);
+  fb.render(lcd, 32);
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.moves);
+  TEST_ASSERT_TRUE(lcd.shows(1, "z"));
+}
+
+void test_bounded_frames() {
+  LcdFramebuffer fb;
+  FakeDisplay lcd;
+  fb.setRow(0, "0123456789ABCDEF", 16);
+  fb.setRow(1, "FEDCBA9876543210", 16);
+  for (uint8_t frame = 0; frame < 4; frame++) {
+    TEST_ASSERT_EQUAL_UINT8(8, fb.render(lcd, 8));
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, fb.render(lcd, 8));
+  TEST_ASSERT_TRUE(lcd.shows(0, "0123456789ABCDEF"));
+  TEST_ASSERT_TRUE(lcd.shows(1, "FEDCBA9876543210"));
+  TEST_ASSERT_EQUAL_UINT32(1, lcd.moves);
+
+  // reconexión: display en blanco, se redibuja todo lo que no es espacio
+  FakeDisplay other;
+  fb.reset();
+  while (fb.render(other, 8)) {}
+  TEST_ASSERT_TRUE(other.shows(0, "0123456789ABCDEF"));
+  TEST_ASSERT_TRUE(other.shows(1, "FEDCBA9876543210"));
+}
+
+void test_write_error() {
+  LcdFramebuffer fb;
+  FakeDisplay lcd;
+  fb.setRow(0, "hola", 4);
+  lcd.unplugged = true;
+  TEST_ASSERT_EQUAL_UINT8(0, fb.render(lcd, 32));
+  TEST_ASSERT_EQUAL_UINT32(1, fb.errors());
+  TEST_ASSERT_TRUE(fb.dirty());
+  // sin reinicializar, al volver se redibuja todo (también los espacios)
+  lcd.unplugged = false;
+  TEST_ASSERT_EQUAL_UINT8(LCD_FB_ROWS * LCD_FB_COLS, fb.render(lcd, 255));
+  TEST_ASSERT_TRUE(lcd.shows(0, "hola"));
+  TEST_ASSERT_FALSE(fb.dirty());
+
+  // se desconecta y se reconecta: init() lo deja en blanco y reset()
+  fb.setRow(1, "chau", 4);
+  lcd.unplugged = true;
+  fb.render(lcd, 32);
+  lcd.unplugged = false;
+  memset(lcd.cells, ' ', sizeof(lcd.cells));
+  lcd.row = lcd.col = 0;
+  fb.reset();
+  while (fb.render(lcd, 8)) {}
+  TEST_ASSERT_TRUE(lcd.shows(0, "hola"));
+  TEST_ASSERT_TRUE(lcd.shows(1, "chau"));
+  TEST_ASSERT_EQUAL_UINT32(2, fb.errors());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_diff_only);
+  RUN_TEST(test_cursor_moves);
+  RUN_TEST(test_bounded_frames);
+  RUN_TEST(test_write_error);
+  return UNITY_END();
+}
@@ -0,0 +1,138 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del log persistente de los sensores sobre un FS en memoria
+// (pio test -e native)
+
+#include <FS.h>
+#include <SensorLog.h>
+#include <unity.h>
+
+const uint32_t RECORD{sizeof(LogRecord)};
+
+void setUp() {}
+void tearDown() {}
+
+void addRecords(SensorLog &log, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    int16_t values[LOG_CHANNELS]{};
+    values[0] = static_cast<int16_t>(log.total());
+    TEST_ASSERT_TRUE(log.add(values, log.total() * 10));
+  }
+}
+
+void test_batches() {
+  fs::FS fs;
+  SensorLog log{fs, "/log"};
+  TEST_ASSERT_TRUE(log.begin());
+  addRecords(log, LOG_BATCH - 1);
+  // hasta juntar LOG_BATCH no se escribe nada
+  TEST_ASSERT_EQUAL_UINT32(0, log.flushed());
+  TEST_ASSERT_EQUAL_UINT32(0, fs.files());
+  addRecords(log, 1);
+  TEST_ASSERT_EQUAL_UINT32(LOG_BATCH, log.flushed());
+  TEST_ASSERT_EQUAL_UINT32(1, log.flushes());
+  TEST_ASSERT_EQUAL_UINT32(LOG_BATCH * RECORD,
+                           fs.open("/log/00000000", "r").size());
+}
+
+void test_segment_rotation() {
+  fs::FS fs;
+  SensorLog log{fs, "/log"};
+  TEST_ASSERT_TRUE(log.begin());
+  addRecords(log, LOG_MAX_SEGMENTS * LOG_SEGMENT_RECORDS);
+  TEST_ASSERT_EQUAL_UINT32(0, log.first());
+  TEST_ASSERT_EQUAL_UINT32(LOG_MAX_SEGMENTS, fs.files());
+  // al empezar un segmento más se borra el más viejo
+  addRecords(log, LOG_BATCH);
+  TEST_ASSERT_EQUAL_UINT32(LOG_SEGMENT_RECORDS, log.first());
+  TEST_ASSERT_EQUAL_UINT32(LOG_MAX_SEGMENTS, fs.files());
+  TEST_ASSERT_FALSE(fs.exists("/log/00000000"));
+  uint8_t buf[RECORD];
+  TEST_ASSERT_EQUAL_UINT32(0, log.read(0, buf, sizeof(buf)));
+  // al reiniciar se retoma desde los segmentos que quedaron
+  SensorLog again{fs, "/log"};
+  TEST_ASSERT_TRUE(again.begin());
+  TEST_ASSERT_EQUAL_UINT32(log.first(), again.first());
+  TEST_ASSERT_EQUAL_UINT32(log.flushed(), again.flushed());
+}
+
+void test_torn_tail() {
+  fs::FS fs;
+  {
+    SensorLog log{fs, "/log"};
+    TEST_ASSERT_TRUE(log.begin());
+    addRecords(log, LOG_BATCH + 3); // los últimos 3 quedan en RAM
+  }
+  // corte de energía a mitad de una escritura: un registro a medias
+  fs::File f = fs.open("/log/00000000", "a");
+  const uint8_t torn[RECORD / 2]{0xAA};
+  f.write(torn, sizeof(torn));
+  f.close();
+  SensorLog log{fs, "/log"};
+  TEST_ASSERT_TRUE(log.begin());
+  TEST_ASSERT_EQUAL_UINT32(LOG_BATCH, log.flushed());
+  TEST_ASSERT_EQUAL_UINT32(LOG_BATCH * RECORD,
+                           fs.open("/log/00000000", "r").size());
+  // la numeración sigue donde quedó el último registro completo
+  addRecords(log, LOG_BATCH);
+  LogRecord r;
+  TEST_ASSERT_EQUAL_UINT32(RECORD, log.read(LOG_BATCH * RECORD,
+                                            reinterpret_cast<uint8_t *>(&r),
+                                            RECORD));
+  TEST_ASSERT_EQUAL_UINT32(LOG_BATCH, r.seq);
+  TEST_ASSERT_EQUAL_INT16(LOG_BATCH, r.values[0]);
+}
+
+void test_read_across_segments() {
+  fs::FS fs;
+  SensorLog log{fs, "/log"};
+  TEST_ASSERT_TRUE(log.begin());
+  addRecords(log, LOG_SEGMENT_RECORDS + LOG_BATCH);
+  LogRecord r[4];
+  uint8_t *buf = reinterpret_cast<uint8_t *>(r);
+  // cada llamada lee de un solo segmento: se corta en el borde
+  uint32_t pos = (LOG_SEGMENT_RECORDS - 2) * RECORD;
+  TEST_ASSERT_EQUAL_UINT32(2 * RECORD, log.read(pos, buf, sizeof(r)));
+  TEST_ASSERT_EQUAL_UINT32(LOG_SEGMENT_RECORDS - 2, r[0].seq);
+  TEST_ASSERT_EQUAL_UINT32(LOG_SEGMENT_RECORDS - 1, r[1].seq);
+  pos += 2 * RECORD;
+  TEST_ASSERT_EQUAL_UINT32(sizeof(r), log.read(pos, buf, sizeof(r)));
+  TEST_ASSERT_EQUAL_UINT32(LOG_SEGMENT_RECORDS, r[0].seq);
+  TEST_ASSERT_EQUAL_UINT32(LOG_SEGMENT_RECORDS + 3, r[3].seq);
+  // las posiciones son en bytes: se puede leer un registro partido
+  LogRecord whole;
+  uint8_t *dst = reinterpret_cast<uint8_t *>(&whole);
+  pos = (LOG_SEGMENT_RECORDS - 1) * RECORD;
+  TEST_ASSERT_EQUAL_UINT32(RECORD / 2, log.read(pos, dst, RECORD / 2));
+  TEST_ASSERT_EQUAL_UINT32(RECORD / 2,
+                           log.read(pos + RECORD / 2, dst + RECORD / 2, RECORD));
+  TEST_ASSERT_EQUAL_UINT32(LOG_SEGMENT_RECORDS - 1, whole.seq);
+  TEST_ASSERT_EQUAL_INT16(LOG_SEGMENT_RECORDS - 1, whole.values[0]);
+  // lo que todavía no se escribió no se lee
+  TEST_ASSERT_EQUAL_UINT32(0, log.read(log.flushed() * RECORD, buf, sizeof(r)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_batches);
+  RUN_TEST(test_segment_rotation);
+  RUN_TEST(test_torn_tail);
+  RUN_TEST(test_read_across_segments);
+  return UNITY_END();
+}
@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests de las métricas de Prometheus (pio test -e native)
+
+#include <Metrics.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+static const char *const DEVICES[]{"lcd", "a\"b"};
+static uint8_t deviceCount() { return 2; }
+static void deviceSample(PromWriter &w, const char *name, uint8_t i) {
+  w.sample(name, "dev", DEVICES[i], 10 + i);
+}
+static void uptimeSample(PromWriter &w, const char *name, uint8_t) {
+  w.sample(name, 4294967296ULL);
+}
+
+static const MetricFamily FAMILIES[]{
+    {"up_seconds", "gauge", "Tiempo encendido.", nullptr, uptimeSample},
+    {"i2c_total", "counter", "Transacciones.", deviceCount, deviceSample},
+};
+
+static const char EXPECTED[]{"# HELP up_seconds Tiempo encendido.\n"
+                             "# TYPE up_seconds gauge\n"
+                             "up_seconds 4294967296\n"
+                             "# HELP i2c_total Transacciones.\n"
+                             "# TYPE i2c_total counter\n"
+                             "i2c_total{dev=\"lcd\"} 10\n"
+                             "i2c_total{dev=\"a\\\"b\"} 11\n"};
+
+static std::string writeAll(size_t chunk) {
+  MetricsCursor cursor{};
+  std::string out;
+  char buf[256];
+  size_t n;
+  while ((n = writeMetrics(FAMILIES, 2, cursor, buf, chunk)) > 0) {
+    TEST_ASSERT_TRUE(n <= chunk);
+    out.append(buf, n);
+  }
+  return out;
+}
+
+void test_whole_text() {
+  TEST_ASSERT_EQUAL_STRING(EXPECTED, writeAll(256).c_str());
+}
+
+void test_small_chunks() {
+  // las líneas quedan cortadas entre partes y se continúan
+  TEST_ASSERT_EQUAL_STRING(EXPECTED, writeAll(7).c_str());
+  TEST_ASSERT_EQUAL_STRING(EXPECTED, writeAll(1).c_str());
+}
+
+void test_line_rollback() {
+  char buf[16];
+  PromWriter w{buf, sizeof(buf)};
+  TEST_ASSERT_TRUE(w.sample("a", 1));
+  TEST_ASSERT_FALSE(w.sample("nombre_largo", 123456));
+  TEST_ASSERT_EQUAL_UINT32(4, w.length());
+  TEST_ASSERT_EQUAL_INT(0, memcmp(buf, "a 1\n", 4));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_whole_text);
+  RUN_TEST(test_small_chunks);
+  RUN_TEST(test_line_rollback);
+  return UNITY_END();
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests de los períodos configurables (pio test -e native)
+
+#include <TaskPeriods.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+static const TaskPeriod TABLE[]{
+    {"rgb", 20, 10, 1000, false},
+    {"aht", 500, 100, 60000, true},
+    {"ldr", 16, 2, 1000, false},
+};
+
+void test_defaults_and_limits() {
+  TaskPeriods periods{TABLE, 3};
+  TEST_ASSERT_EQUAL_UINT32(20, periods.get(0));
+  TEST_ASSERT_EQUAL_INT8(1, periods.find("aht", 3));
+  TEST_ASSERT_EQUAL_INT8(-1, periods.find("ah", 2));
+  TEST_ASSERT_FALSE(periods.set(0, 9));
+  TEST_ASSERT_FALSE(periods.set(0, 1001));
+  TEST_ASSERT_FALSE(periods.set(3, 100));
+  TEST_ASSERT_EQUAL_UINT32(20, periods.get(0));
+  TEST_ASSERT_TRUE(periods.set(0, 10));
+  TEST_ASSERT_EQUAL_UINT32(10, periods.get(0));
+  periods.reset();
+  TEST_ASSERT_EQUAL_UINT32(20, periods.get(0));
+}
+
+void test_serialize_only_changes() {
+  TaskPeriods periods{TABLE, 3};
+  char buf[64];
+  TEST_ASSERT_EQUAL_UINT32(0, periods.serialize(buf, sizeof(buf)));
+  periods.set(1, 2000);
+  periods.set(2, 8);
+  TEST_ASSERT_EQUAL_UINT32(15, periods.serialize(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("aht=2000\nldr=8\n", buf);
+  // si no entra no se escribe nada a medias
+  TEST_ASSERT_EQUAL_UINT32(0, periods.serialize(buf, 10));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void test_parse_round_trip() {
+  TaskPeriods saved{TABLE, 3}, loaded{TABLE, 3};
+  saved.set(0, 50);
+  saved.set(2, 4);
+  char buf[64];
+  size_t len = saved.serialize(buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT8(2, loaded.parse(buf, len));
+  TEST_ASSERT_EQUAL_UINT32(50, loaded.get(0));
+  TEST_ASSERT_EQUAL_UINT32(500, loaded.get(1));
+  TEST_ASSERT_EQUAL_UINT32(4, loaded.get(2));
+}
+
+void test_parse_ignores_invalid() {
+  TaskPeriods periods{TABLE, 3};
+  const char text[]{"rgb=5\nxyz=100\naht=12a\nldr=\n=3\nldr=99999999999\naht=700"};
+  TEST_ASSERT_EQUAL_UINT8(1, periods.parse(text, strlen(text)));
+  TEST_ASSERT_EQUAL_UINT32(20, periods.get(0));
+  TEST_ASSERT_EQUAL_UINT32(700, periods.get(1));
+  TEST_ASSERT_EQUAL_UINT32(16, periods.get(2));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_defaults_and_limits);
+  RUN_TEST(test_serialize_only_changes);
+  RUN_TEST(test_parse_round_trip);
+  RUN_TEST(test_parse_ignores_invalid);
+  return UNITY_END();
+}
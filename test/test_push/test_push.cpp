@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del envío del estado a cada cliente (pio test -e native)
+
+#include <StatePush.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_nothing_to_send() {
+  StateBacklog b{};
+  TEST_ASSERT_EQUAL_UINT8(PUSH_SKIP, pushAction(b, false, false, true, false));
+  // sin lugar pero sin nada nuevo tampoco se retiene
+  TEST_ASSERT_EQUAL_UINT8(PUSH_SKIP, pushAction(b, false, false, false, true));
+}
+
+void test_delta_or_full() {
+  StateBacklog b{};
+  TEST_ASSERT_EQUAL_UINT8(PUSH_DELTA, pushAction(b, true, false, true, true));
+  TEST_ASSERT_EQUAL_UINT8(PUSH_FULL, pushAction(b, true, false, true, false));
+  TEST_ASSERT_EQUAL_UINT8(PUSH_FULL, pushAction(b, false, true, true, false));
+}
+
+void test_hold_and_coalesce() {
+  StateBacklog b{};
+  TEST_ASSERT_EQUAL_UINT8(PUSH_HOLD, pushAction(b, true, false, false, true));
+  pushHold(b, true, 100);
+  TEST_ASSERT_TRUE(b.pending);
+  TEST_ASSERT_EQUAL_UINT32(100, b.since_ms);
+  TEST_ASSERT_EQUAL_UINT32(0, b.coalesced);
+  // sigue sin lugar: el nuevo estado reemplaza al retenido
+  pushHold(b, true, 120);
+  pushHold(b, false, 140); // sin cambios no se reemplaza nada
+  TEST_ASSERT_EQUAL_UINT32(100, b.since_ms);
+  TEST_ASSERT_EQUAL_UINT32(1, b.coalesced);
+  // retenido: aunque no haya cambios se envía el último completo
+  TEST_ASSERT_EQUAL_UINT8(PUSH_FULL, pushAction(b, false, false, true, true));
+  pushSent(b, 160);
+  TEST_ASSERT_FALSE(b.pending);
+  TEST_ASSERT_EQUAL_UINT32(60, b.max_lag_ms);
+  TEST_ASSERT_EQUAL_UINT8(PUSH_DELTA, pushAction(b, true, false, true, true));
+  pushSent(b, 200);
+  TEST_ASSERT_EQUAL_UINT32(60, b.max_lag_ms);
+}
+
+void test_hold_without_buffer() {
+  // Si no se pudo armar el delta se retiene como con la cola llena
+  StateBacklog b{};
+  pushHold(b, true, 50);
+  TEST_ASSERT_TRUE(b.pending);
+  TEST_ASSERT_EQUAL_UINT32(50, b.since_ms);
+  TEST_ASSERT_EQUAL_UINT8(PUSH_FULL, pushAction(b, false, false, true, true));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_to_send);
+  RUN_TEST(test_delta_or_full);
+  RUN_TEST(test_hold_and_coalesce);
+  RUN_TEST(test_hold_without_buffer);
+  return UNITY_END();
+}
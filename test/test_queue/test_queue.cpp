@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests de la SpscQueue (pio test -e native)
+
+#include <Arduino.h>
+#include <SpscQueue.h>
+#include <thread>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_fifo_and_overflow() {
+  SpscQueue<uint32_t, 4> q;
+  uint32_t v = 0;
+  TEST_ASSERT_FALSE(q.pop(v));
+  for (uint32_t i = 0; i < 4; i++) TEST_ASSERT_TRUE(q.push(i));
+  TEST_ASSERT_FALSE(q.push(99));
+  TEST_ASSERT_EQUAL_UINT32(1, q.overflows());
+  TEST_ASSERT_EQUAL_UINT32(4, q.highWater());
+  // da varias vueltas al arreglo manteniendo el orden
+  for (uint32_t i = 4; i < 100; i++) {
+    TEST_ASSERT_TRUE(q.pop(v));
+    TEST_ASSERT_EQUAL_UINT32(i - 4, v);
+    TEST_ASSERT_TRUE(q.push(i));
+  }
+  TEST_ASSERT_EQUAL_UINT32(4, q.size());
+}
+
+void test_reserve_in_place() {
+  struct Big {
+    uint16_t len;
+    char data[64];
+  };
+  SpscQueue<Big, 2> q;
+  Big *slot = q.reserve();
+  TEST_ASSERT_NOT_NULL(slot);
+  TEST_ASSERT_TRUE(q.empty()); // no se ve hasta commit()
+  slot->len = 4;
+  memcpy(slot->data, "hola", 4);
+  q.commit();
+  q.push(Big{1, "x"});
+  TEST_ASSERT_NULL(q.reserve());
+  TEST_ASSERT_EQUAL_UINT32(1, q.overflows());
+  Big *first = q.front();
+  TEST_ASSERT_EQUAL_UINT32(4, first->len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY("hola", first->data, 4);
+  q.release();
+  TEST_ASSERT_EQUAL_UINT32(1, q.size());
+}
+
+void test_two_threads() {
+  // un productor y un consumidor reales: no se pierde ni se repite nada
+  static SpscQueue<uint32_t, 8> q;
+  const uint32_t total = 20000;
+  std::thread producer([] {
+    for (uint32_t i = 0; i < total;) {
+      if (q.push(i)) {
+        i++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint32_t expected = 0, v = 0;
+  while (expected < total) {
+    if (q.pop(v)) {
+      if (v != expected) break;
+      expected++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  TEST_ASSERT_EQUAL_UINT32(total, expected);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo_and_overflow);
+  RUN_TEST(test_reserve_in_place);
+  RUN_TEST(test_two_threads);
+  return UNITY_END();
+}
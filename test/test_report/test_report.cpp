@@ -0,0 +1,113 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del reporte por excepción y el muestreo adaptivo (pio test -e native)
+
+#include <ReportFilter.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+void test_absolute_deadband() {
+  ReportFilter f{ReportPolicy{0.5f, false, 0, 0}};
+  TEST_ASSERT_TRUE(f.offer(20.0f, 0)); // el primero siempre
+  TEST_ASSERT_FALSE(f.offer(20.3f, 100));
+  TEST_ASSERT_FALSE(f.offer(19.6f, 200));
+  TEST_ASSERT_TRUE(f.offer(20.6f, 300));
+  TEST_ASSERT_EQUAL_FLOAT(20.6f, f.reported());
+  TEST_ASSERT_EQUAL_UINT32(2, f.reports());
+  TEST_ASSERT_EQUAL_UINT32(2, f.suppressed());
+}
+
+void test_percent_deadband() {
+  ReportFilter f{ReportPolicy{10, true, 0, 0}};
+  f.offer(200, 0);
+  TEST_ASSERT_EQUAL_FLOAT(20, f.band());
+  TEST_ASSERT_FALSE(f.offer(219, 10));
+  TEST_ASSERT_TRUE(f.offer(179, 20));
+  // la banda sigue al valor reportado
+  TEST_ASSERT_EQUAL_FLOAT(17.9f, f.band());
+}
+
+void test_min_and_max_interval() {
+  ReportFilter f{ReportPolicy{1, false, 1000, 5000}};
+  f.offer(10, 0);
+  // se mueve pero todavía no pasó el intervalo mínimo
+  TEST_ASSERT_FALSE(f.offer(15, 500));
+  TEST_ASSERT_TRUE(f.offer(15, 1000));
+  // quieto: se reporta igual al pasar el intervalo máximo
+  TEST_ASSERT_FALSE(f.offer(15.2f, 5999));
+  TEST_ASSERT_TRUE(f.offer(15.2f, 6000));
+  TEST_ASSERT_EQUAL_FLOAT(15.2f, f.reported());
+}
+
+void test_policy_validation() {
+  ReportFilter f{ReportPolicy{1, false, 0, 0}};
+  TEST_ASSERT_FALSE(f.setPolicy(ReportPolicy{-1, false, 0, 0}));
+  TEST_ASSERT_FALSE(f.setPolicy(ReportPolicy{1, false, 2000, 1000}));
+  f.offer(10, 0);
+  TEST_ASSERT_TRUE(f.setPolicy(ReportPolicy{5, false, 0, 0}));
+  // después de cambiar la política se reporta el próximo valor
+  TEST_ASSERT_TRUE(f.offer(10, 1));
+}
+
+void test_adaptive_period() {
+  ReportFilter f{ReportPolicy{1, false, 0, 0}};
+  AdaptivePeriod p{3, 2};
+  f.offer(10, 0);
+  for (int i = 0; i < 20; i++) {
+    f.offer(10.1f, i);
+    p.update(f.moving());
+  }
+  // quieto: 2 muestras por duplicación, hasta 8 veces el base
+  TEST_ASSERT_EQUAL_UINT32(4000, p.period(500));
+  // un salto de media banda o más vuelve al base
+  f.offer(10.7f, 30);
+  TEST_ASSERT_TRUE(f.moving());
+  p.update(f.moving());
+  TEST_ASSERT_EQUAL_UINT32(500, p.period(500));
+  f.offer(10.7f, 31);
+  p.update(f.moving());
+  f.offer(10.7f, 32);
+  p.update(f.moving());
+  TEST_ASSERT_EQUAL_UINT32(1000, p.period(500));
+}
+
+void test_adaptive_period_limit() {
+  AdaptivePeriod p{3, 1};
+  for (int i = 0; i < 5; i++) p.update(false);
+  TEST_ASSERT_EQUAL_UINT8(3, p.shift());
+  // el período alargado no pasa el intervalo máximo de reporte
+  TEST_ASSERT_EQUAL_UINT32(3000, p.period(500, 3000));
+  TEST_ASSERT_EQUAL_UINT32(4000, p.period(500, 60000));
+  TEST_ASSERT_EQUAL_UINT32(4000, p.period(500, 0));
+  // pero tampoco baja del base
+  TEST_ASSERT_EQUAL_UINT32(500, p.period(500, 200));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_absolute_deadband);
+  RUN_TEST(test_percent_deadband);
+  RUN_TEST(test_min_and_max_interval);
+  RUN_TEST(test_policy_validation);
+  RUN_TEST(test_adaptive_period);
+  RUN_TEST(test_adaptive_period_limit);
+  return UNITY_END();
+}
@@ -0,0 +1,123 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests del PeriodicTaskManager en la PC (pio test -e native)
+
+#include <Arduino.h>
+#include <PeriodicTaskManager.h>
+#include <unity.h>
+
+static uint32_t runs[4];
+static void taskA(uint8_t) { runs[0]++; }
+static void taskB(uint8_t) { runs[1]++; }
+static void taskC(uint8_t) { runs[2]++; }
+static void slowTask(uint8_t) {
+  runs[3]++;
+  shim::advanceMillis(30);
+}
+
+void setUp() {
+  memset(runs, 0, sizeof(runs));
+  shim::setMicros(0);
+}
+
+void tearDown() {}
+
+static void runFor(PeriodicTaskManager &tasker, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    shim::advanceMillis(1);
+    tasker.refresh();
+  }
+}
+
+void test_periods() {
+  PeriodicTaskManager tasker;
+  tasker.add(taskA, "a", 4);
+  tasker.add(taskB, "b", 50);
+  runFor(tasker, 1000);
+  TEST_ASSERT_EQUAL_UINT32(250, runs[0]);
+  TEST_ASSERT_EQUAL_UINT32(20, runs[1]);
+}
+
+void test_millis_wraparound() {
+  // Arranca 100 ms antes de que millis() desborde
+  shim::setMicros((uint64_t(UINT32_MAX) - 100) * 1000);
+  PeriodicTaskManager tasker;
+  tasker.add(taskA, "a", 10);
+  runFor(tasker, 1000);
+  TEST_ASSERT_EQUAL_UINT32(100, runs[0]);
+  TEST_ASSERT_TRUE(tasker.msToNextTask() <= 10);
+}
+
+void test_handles() {
+  PeriodicTaskManager tasker;
+  TaskHandle a = tasker.add(taskA, "a", 10);
+  TEST_ASSERT_TRUE(a.valid());
+  TEST_ASSERT_TRUE(tasker.pause(a));
+  runFor(tasker, 100);
+  TEST_ASSERT_EQUAL_UINT32(0, runs[0]);
+  TEST_ASSERT_TRUE(tasker.unpause("a"));
+  runFor(tasker, 100);
+  TEST_ASSERT_EQUAL_UINT32(10, runs[0]);
+  TEST_ASSERT_TRUE(tasker.remove(a));
+  // El lugar se reutiliza: el handle viejo ya no es válido
+  TaskHandle b = tasker.add(taskB, "b", 10);
+  TEST_ASSERT_EQUAL_UINT8(a.index, b.index);
+  TEST_ASSERT_FALSE(tasker.pause(a));
+  TEST_ASSERT_FALSE(tasker.pause("a"));
+  TEST_ASSERT_FALSE(tasker.pause(TaskHandle{}));
+}
+
+void test_overrun_policies() {
+  PeriodicTaskManager tasker;
+  TaskHandle a = tasker.add(taskA, "a", 4, OverrunPolicy::CATCH_UP);
+  TaskHandle b = tasker.add(taskB, "b", 4, OverrunPolicy::SKIP);
+  tasker.add(taskC, "c", 4, OverrunPolicy::FROM_COMPLETION);
+  shim::advanceMillis(100);
+  for (uint8_t i = 0; i < 10; i++) tasker.refresh();
+  // A lo sumo una ejecución por tarea en cada refresh()
+  TEST_ASSERT_EQUAL_UINT32(10, runs[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, runs[1]);
+  TEST_ASSERT_EQUAL_UINT32(1, runs[2]);
+  TEST_ASSERT_EQUAL_UINT32(10, tasker.overruns(a));
+  TEST_ASSERT_EQUAL_UINT32(1, tasker.overruns(b));
+  // totales: 12 ejecuciones, la primera de cada una 96 ms tarde
+  TEST_ASSERT_EQUAL_UINT32(12, tasker.runs());
+  TEST_ASSERT_EQUAL_UINT32(96, tasker.lateMaxMs());
+  TEST_ASSERT_TRUE(tasker.lateTotalMs() >= 3 * 96);
+}
+
+void test_from_completion() {
+  PeriodicTaskManager tasker;
+  tasker.add(slowTask, "slow", 10, OverrunPolicy::FROM_COMPLETION);
+  runFor(tasker, 10);
+  TEST_ASSERT_EQUAL_UINT32(1, runs[3]);
+  // terminó en t=40, la próxima es en t=50
+  TEST_ASSERT_EQUAL_UINT32(10, tasker.msToNextTask());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_periods);
+  RUN_TEST(test_millis_wraparound);
+  RUN_TEST(test_handles);
+  RUN_TEST(test_overrun_policies);
+  RUN_TEST(test_from_completion);
+  return UNITY_END();
+}
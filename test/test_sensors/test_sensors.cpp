@@ -0,0 +1,105 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests de la lectura en dos fases de los sensores I2C (pio test -e native)
+
+#include <Arduino.h>
+#include <SplitPhaseSensor.h>
+#include <Wire.h>
+#include <unity.h>
+
+void setUp() {
+  shim::setMicros(0);
+  Wire = TwoWire{};
+}
+
+void tearDown() {}
+
+void test_aht10_split_phase() {
+  AHT10Sensor aht;
+  TEST_ASSERT_TRUE(aht.begin());
+  const uint8_t init[]{0xE1, 0x08, 0x00};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(init, Wire.written, 3);
+
+  // primera fase: dispara la conversión y pide volver en 80ms
+  TEST_ASSERT_EQUAL_UINT32(AHT10Sensor::CONVERSION_MS, aht.step(500));
+  const uint8_t measure[]{0xAC, 0x33, 0x00};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(measure, Wire.written, 3);
+  TEST_ASSERT_TRUE(aht.converting());
+  TEST_ASSERT_FALSE(aht.takeReading());
+
+  // llamada antes de tiempo: no lee, devuelve lo que falta
+  shim::advanceMillis(30);
+  TEST_ASSERT_EQUAL_UINT32(50, aht.step(500));
+
+  // segunda fase: 50% de humedad y 25°C en una misma lectura
+  shim::advanceMillis(50);
+  const uint8_t raw[]{0x1C, 0x80, 0x00, 0x06, 0x00, 0x00};
+  Wire.respond(raw, sizeof(raw));
+  TEST_ASSERT_EQUAL_UINT32(420, aht.step(500));
+  TEST_ASSERT_FALSE(aht.converting());
+  TEST_ASSERT_TRUE(aht.takeReading());
+  TEST_ASSERT_FALSE(aht.takeReading());
+  TEST_ASSERT_EQUAL_FLOAT(50.0f, aht.humidity());
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, aht.temperature());
+  // inicialización, disparo y lectura
+  TEST_ASSERT_EQUAL_UINT32(3, aht.transactions());
+}
+
+void test_aht10_busy_and_missing() {
+  AHT10Sensor aht;
+  aht.begin();
+  aht.step(500);
+  shim::advanceMillis(80);
+  // bit de ocupado: se reintenta sin perder la conversión
+  const uint8_t busy[]{0x9C, 0, 0, 0, 0, 0};
+  Wire.respond(busy, sizeof(busy));
+  TEST_ASSERT_EQUAL_UINT32(AHT10Sensor::CONVERSION_MS / 4 + 1, aht.step(500));
+  TEST_ASSERT_TRUE(aht.converting());
+
+  // si se desconecta, la lectura falla y se espera el resto del período
+  Wire.present = false;
+  shim::advanceMillis(21);
+  TEST_ASSERT_EQUAL_UINT32(500 - 101, aht.step(500));
+  TEST_ASSERT_FALSE(aht.takeReading());
+  TEST_ASSERT_EQUAL_UINT32(1, aht.errors());
+  TEST_ASSERT_EQUAL_UINT32(500, aht.step(500));
+  TEST_ASSERT_EQUAL_UINT32(2, aht.errors());
+}
+
+void test_bh1750_one_time() {
+  BH1750Sensor bh;
+  TEST_ASSERT_TRUE(bh.begin());
+  TEST_ASSERT_EQUAL_UINT32(BH1750Sensor::CONVERSION_MS, bh.step(200));
+  TEST_ASSERT_EQUAL_HEX8(0x20, Wire.written[0]);
+  shim::advanceMillis(180);
+  const uint8_t raw[]{0x04, 0xB0}; // 1200 cuentas
+  Wire.respond(raw, sizeof(raw));
+  TEST_ASSERT_EQUAL_UINT32(20, bh.step(200));
+  TEST_ASSERT_TRUE(bh.takeReading());
+  TEST_ASSERT_EQUAL_FLOAT(1000.0f, bh.lux());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_aht10_split_phase);
+  RUN_TEST(test_aht10_busy_and_missing);
+  RUN_TEST(test_bh1750_one_time);
+  return UNITY_END();
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Tests del StaticSlot (pio test -e native)
+
+#include <StaticSlot.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+static int alive = 0;
+
+struct Driver {
+  uint8_t address;
+  uint8_t cols;
+  Driver(uint8_t address, uint8_t cols) : address{address}, cols{cols} { alive++; }
+  ~Driver() { alive--; }
+};
+
+void test_emplace_and_reset() {
+  StaticSlot<Driver> slot;
+  TEST_ASSERT_FALSE(bool(slot));
+  TEST_ASSERT_NULL(slot.get());
+  Driver &d = slot.emplace(0x27, 16);
+  TEST_ASSERT_TRUE(bool(slot));
+  TEST_ASSERT_EQUAL_PTR(&d, slot.get());
+  TEST_ASSERT_EQUAL_UINT8(0x27, slot->address);
+  TEST_ASSERT_EQUAL_UINT8(16, (*slot).cols);
+  TEST_ASSERT_EQUAL_INT(1, alive);
+  slot.reset();
+  TEST_ASSERT_FALSE(bool(slot));
+  TEST_ASSERT_EQUAL_INT(0, alive);
+  slot.reset(); // sin objeto no hace nada
+  TEST_ASSERT_EQUAL_INT(0, alive);
+}
+
+void test_emplace_again_reuses_storage() {
+  StaticSlot<Driver> slot;
+  Driver *first = &slot.emplace(0x3F, 16);
+  // construir de nuevo destruye el anterior y usa el mismo lugar
+  Driver *second = &slot.emplace(0x27, 20);
+  TEST_ASSERT_EQUAL_PTR(first, second);
+  TEST_ASSERT_EQUAL_INT(1, alive);
+  TEST_ASSERT_EQUAL_UINT8(0x27, slot->address);
+  TEST_ASSERT_EQUAL_UINT32(2, slot.constructions());
+  TEST_ASSERT_EQUAL_UINT32(0, reinterpret_cast<uintptr_t>(second) % alignof(Driver));
+}
+
+void test_destructor_releases() {
+  {
+    StaticSlot<Driver> slot;
+    slot.emplace(0x27, 16);
+    TEST_ASSERT_EQUAL_INT(1, alive);
+  }
+  TEST_ASSERT_EQUAL_INT(0, alive);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_emplace_and_reset);
+  RUN_TEST(test_emplace_again_reuses_storage);
+  RUN_TEST(test_destructor_releases);
+  return UNITY_END();
+}
@@ -0,0 +1,150 @@
+// Copyright (C) 2024 Matías S. Ávalos (@tute_avalos)
+//
+// This file is part of esp8266-io-board-websocket.
+//
+// esp8266-io-board-websocket is free software: you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// esp8266-io-board-websocket is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with esp8266-io-board-websocket.  If not, see
+// <https://www.gnu.org/licenses/>.
+
+
+// Tests de la serialización del estado y de los comandos (pio test -e native)
+
+#include <BoardState.h>
+#include <WsCommand.h>
+#include <unity.h>
+
+static BoardState sampleState() {
+  BoardState state{};
+  state.rgb = 0x0A0BFC;
+  state.btns[1] = true;
+  state.ldr = 1023;
+  state.lcd_connected = true;
+  strcpy(state.lcdrows[0], "hola \"mundo\"");
+  state.aht_connected = true;
+  state.tmp = -3.456f;
+  state.hum = 55.5f;
+  return state;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_json() {
+  BoardState state = sampleState();
+  char json[STATE_JSON_MAX];
+  size_t len = stateToJson(state, json, sizeof(json));
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"rgb\":\"#0A0BFC\",\"btn1\":0,\"btn2\":1,\"ldr\":1023,"
+      "\"lcd_connected\":true,\"lcd1row\":\"hola \\\"mundo\\\"\","
+      "\"lcd2row\":\"\",\"aht_connected\":true,\"tmp\":-3.46,"
+      "\"hum\":55.50,\"bh_connected\":false}",
+      json);
+  TEST_ASSERT_EQUAL_UINT32(strlen(json), len);
+  // Si no entra en el buffer no se devuelve nada
+  TEST_ASSERT_EQUAL_UINT32(0, stateToJson(state, json, 32));
+}
+
+void test_binary() {
+  BoardState state = sampleState();
+  uint8_t frame[STATE_BIN_MAX];
+  size_t len = stateToBinary(state, STATE_FIELD_ALL, frame, sizeof(frame));
+  // 3 de cabecera, rgb 3, btns 1, ldr 2, tmp 2, hum 2, lcd 32, fx 5 (sin lx)
+  TEST_ASSERT_EQUAL_UINT32(50, len);
+  const uint8_t head[]{STATE_BIN_VERSION, 0x03, STATE_FIELD_ALL & ~STATE_FIELD_LX,
+                       0x0A, 0x0B, 0xFC, 0x02, 0xFF, 0x03,
+                       0xA6, 0xFE, 0xAE, 0x15};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(head, frame, sizeof(head));
+}
+
+void test_binary_delta() {
+  BoardState a = sampleState(), b = a;
+  b.ldr = 10;
+  uint8_t fields = stateDiff(a, b);
+  TEST_ASSERT_EQUAL_UINT8(STATE_FIELD_LDR, fields);
+  uint8_t frame[STATE_BIN_MAX];
+  TEST_ASSERT_EQUAL_UINT32(5, stateToBinary(b, fields, frame, sizeof(frame)));
+}
+
+void test_effect_fields() {
+  BoardState a = sampleState(), b = a;
+  b.fx = EFFECT_FADE;
+  b.fx_period = 36000;
+  // cambiar de efecto es un cambio, el color que muestra no forma parte
+  TEST_ASSERT_EQUAL_UINT8(STATE_FIELD_FX, stateDiff(a, b));
+  TEST_ASSERT_TRUE(a != b);
+  uint8_t frame[STATE_BIN_MAX];
+  TEST_ASSERT_EQUAL_UINT32(8, stateToBinary(b, STATE_FIELD_FX, frame, sizeof(frame)));
+  const uint8_t fx[]{EFFECT_FADE, 0xA0, 0x8C, 0x00, 0x00};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(fx, frame + 3, sizeof(fx));
+  char json[STATE_JSON_MAX];
+  stateToJson(b, json, sizeof(json));
+  const char *head = "{\"rgb\":\"#0A0BFC\",\"fx\":\"fade\",\"fx_period\":36000,";
+  TEST_ASSERT_EQUAL_STRING_LEN(head, json, strlen(head));
+}
+
+void test_lookup_command() {
+  TEST_ASSERT_EQUAL_INT8(CMD_DAT, lookupCommand((const uint8_t *)"dat", 3));
+  TEST_ASSERT_EQUAL_INT8(CMD_LCD, lookupCommand((const uint8_t *)"lcd=0hola", 9));
+  TEST_ASSERT_EQUAL_INT8(CMD_BAT, lookupCommand((const uint8_t *)"bat\nsub", 7));
+  TEST_ASSERT_EQUAL_INT8(CMD_INVALID, lookupCommand((const uint8_t *)"da", 2));
+  TEST_ASSERT_EQUAL_INT8(CMD_INVALID, lookupCommand((const uint8_t *)"xyz", 3));
+  for (int8_t i = 0; i < CMD_COUNT; i++) {
+    TEST_ASSERT_EQUAL_INT8(i, lookupCommand((const uint8_t *)COMMAND_NAMES[i], 3));
+  }
+}
+
+void test_command_replies() {
+  TEST_ASSERT_FALSE(commandReplies(CMD_LCD));
+  TEST_ASSERT_FALSE(commandReplies(CMD_SUB));
+  TEST_ASSERT_TRUE(commandReplies(CMD_DAT));
+  TEST_ASSERT_TRUE(commandReplies(CMD_EFX));
+  TEST_ASSERT_TRUE(commandReplies(CMD_BAT));
+  TEST_ASSERT_TRUE(commandReplies(CMD_INVALID));
+}
+
+void test_message_assembler() {
+  MessageAssembler message;
+  // Dos frames ("lcd=0" + "Hola"), el segundo partido en dos paquetes
+  TEST_ASSERT_EQUAL_UINT8(MessageAssembler::INCOMPLETE,
+                          message.feed(true, false, 0, 5, (const uint8_t *)"lcd=0", 5));
+  TEST_ASSERT_EQUAL_UINT8(MessageAssembler::INCOMPLETE,
+                          message.feed(false, true, 0, 4, (const uint8_t *)"Ho", 2));
+  TEST_ASSERT_EQUAL_UINT8(MessageAssembler::COMPLETE,
+                          message.feed(false, true, 2, 4, (const uint8_t *)"la", 2));
+  TEST_ASSERT_EQUAL_UINT32(9, message.length());
+  TEST_ASSERT_EQUAL_MEMORY("lcd=0Hola", message.data(), 9);
+
+  // Un mensaje más largo que el buffer se descarta y se informa una vez
+  static uint8_t big[WS_MAX_MESSAGE];
+  memset(big, 'x', sizeof(big));
+  TEST_ASSERT_EQUAL_UINT8(MessageAssembler::INCOMPLETE,
+                          message.feed(true, false, 0, sizeof(big), big, sizeof(big)));
+  TEST_ASSERT_EQUAL_UINT8(MessageAssembler::TOO_LONG,
+                          message.feed(false, true, 0, 1, big, 1));
+  TEST_ASSERT_EQUAL_UINT8(MessageAssembler::COMPLETE,
+                          message.feed(true, true, 0, 3, (const uint8_t *)"dat", 3));
+  TEST_ASSERT_EQUAL_UINT32(3, message.length());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_json);
+  RUN_TEST(test_binary);
+  RUN_TEST(test_binary_delta);
+  RUN_TEST(test_effect_fields);
+  RUN_TEST(test_lookup_command);
+  RUN_TEST(test_command_replies);
+  RUN_TEST(test_message_assembler);
+  return UNITY_END();
+}
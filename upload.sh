@@ -18,13 +18,16 @@
 # along with esp8266-io-board-websocket.  If not, see 
 # <https://www.gnu.org/licenses/>.
 
-./populate_data.sh
-
+# La página web se embebe en el firmware (embed_assets.py), la imagen del
+# filesystem solo se graba con --fs (borra el log de los sensores)
 source ~/.platformio/penv/bin/activate
 
 pio run
 pio run -t upload
-pio run -t buildfs
-pio run -t uploadfs
+if [ "$1" = "--fs" ]; then
+    ./populate_data.sh
+    pio run -t buildfs
+    pio run -t uploadfs
+fi
 
 deactivate